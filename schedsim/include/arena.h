@@ -0,0 +1,103 @@
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include <stddef.h>
+
+/**
+ * Block of memory of an arena. Allocations are carved sequentially from
+ * the data area.
+ */
+typedef struct arena_block {
+
+    struct arena_block * next;
+    size_t size;
+    size_t used;
+
+    /** Keeps the data area aligned for any type */
+    union {
+        long double alignLongDouble;
+        void * alignPointer;
+        long long alignLongLong;
+    } data[];
+
+} ArenaBlock_t;
+
+/**
+ * Region-based allocator. Objects are never freed individually: the whole
+ * arena is released at once.
+ */
+typedef struct {
+
+    ArenaBlock_t * blocks;
+
+    /** Size of the next block to allocate */
+    size_t blockSize;
+
+} Arena_t;
+
+/**
+ * @brief Initializes an arena.
+ *
+ * No memory is allocated until the first allocation.
+ *
+ * @param arena Pointer to the arena.
+ */
+void initArena(Arena_t * arena);
+
+/**
+ * @brief Initializes an arena with a given size for its first block.
+ *
+ * Small arenas, e.g. one per object, save memory with a small first block.
+ *
+ * @param arena Pointer to the arena.
+ * @param blockSize Size of the first block in bytes.
+ */
+void initArenaWithBlockSize(Arena_t * arena, size_t blockSize);
+
+/**
+ * @brief Allocates a chunk of memory from an arena.
+ *
+ * The chunk is aligned for any type and stays valid until the arena is
+ * released.
+ *
+ * @param arena Pointer to the arena.
+ * @param size Size of the chunk in bytes.
+ *
+ * @return Pointer to the chunk or NULL if there is not enough memory.
+ */
+void * arenaAlloc(Arena_t * arena, size_t size);
+
+/**
+ * @brief Copies a string of a given length into an arena.
+ *
+ * @param arena Pointer to the arena.
+ * @param string The string to copy, not necessarily '\0'-terminated.
+ * @param length Number of characters to copy.
+ *
+ * @return Pointer to the '\0'-terminated copy or NULL if there is not
+ * enough memory.
+ */
+char * arenaStrndup(Arena_t * arena, const char * string, size_t length);
+
+/**
+ * @brief Moves all the memory of an arena into another one.
+ *
+ * The chunks allocated from the other arena stay valid and now belong to
+ * the arena, which keeps allocating from its current block. The other arena
+ * is left initialized and empty.
+ *
+ * @param arena Pointer to the arena that takes the memory.
+ * @param other Pointer to the arena that gives its memory away.
+ */
+void mergeArena(Arena_t * arena, Arena_t * other);
+
+/**
+ * @brief Releases all the memory of an arena.
+ *
+ * The arena is left initialized and empty, so it can be reused.
+ *
+ * @param arena Pointer to the arena.
+ */
+void freeArena(Arena_t * arena);
+
+#endif // __ARENA_H__
@@ -1,8 +1,22 @@
 #ifndef __DESCRIPTORS_H__
 #define __DESCRIPTORS_H__
 
+#include <stdint.h>
+#include <limits.h>
+
 #include <tasks.h>
+#include <metrics.h>
+#include <arena.h>
+#include <devices.h>
+
+/** Partition of a task that is not pinned to any */
+#define ANY_PARTITION UINT_MAX
 
+/**
+ * Type of a burst. A burst of type n > 0 is served by device n - 1 of the
+ * device table of the workload. The hard disk and the keyboard are the
+ * devices of the workloads that do not declare any.
+ */
 typedef enum {
 
     CPU = 0,
@@ -11,33 +25,65 @@ typedef enum {
 
 } TaskBehaviourType_t;
 
-typedef struct task_behaviour {
-
-    TaskBehaviourType_t type;
-    unsigned int remainingTime;
+/**
+ * Bursts of a task, stored as two parallel arrays. The simulation never
+ * modifies them: the progress of the task is kept in its descriptor, so the
+ * arrays may live in read-only memory.
+ */
+typedef struct {
 
-    struct task_behaviour * next;
-    struct task_behaviour * prev;
+    unsigned int size;
 
-} TaskBehaviour_t;
+    /** Type of every burst, a TaskBehaviourType_t stored in a byte */
+    uint8_t * types;
 
-typedef struct {
+    /** Duration of every burst */
+    uint32_t * durations;
 
-    unsigned int size;
-    TaskBehaviour_t * first;
-    TaskBehaviour_t * last;
+    /**
+     * Sector accessed by every burst, used by the disk disciplines of the
+     * devices. NULL if the task does not give any sector, which makes all
+     * of them 0
+     */
+    uint32_t * sectors;
 
-} TaskBehaviourList_t;
+} TaskBursts_t;
 
 typedef struct task_descriptor {
 
     PCB_t pcb;
     unsigned int startTime;
+    unsigned int priority;
+
+    /**
+     * Quantum of the task for the round robin policy, or 0 to use the
+     * quantum of the simulation
+     */
+    unsigned int quantum;
+
+    /**
+     * Partition of the CPUs the task is pinned to, or ANY_PARTITION to
+     * spread the tasks over the partitions by PID
+     */
+    unsigned int partition;
+
     unsigned int items;
 
-    TaskBehaviour_t * current;
+    /** Index of the current burst */
+    unsigned int current;
+
+    /** Remaining time of the current burst */
+    unsigned int remainingTime;
+
+    /** Tick in which the current I/O request was issued to its device */
+    unsigned int requestTime;
 
-    TaskBehaviourList_t behaviours;
+    TaskBursts_t bursts;
+
+    TaskMetrics_t metrics;
+
+    /** Simulator the task is running on, NULL until it arrives */
+    struct simulator * sim;
 
     struct task_descriptor * next;
     struct task_descriptor * prev;
@@ -50,17 +96,77 @@ typedef struct {
     TaskDescriptor_t * first;
     TaskDescriptor_t * last;
 
+    /** Memory of the descriptors, their bursts and their commands */
+    Arena_t arena;
+
+    /** Devices used by the bursts of the descriptors */
+    DeviceTable_t devices;
+
+    /**
+     * File mapped by the binary loader, the bursts and the commands point
+     * into it
+     */
+    void * mapping;
+    size_t mappingSize;
+
 } TaskDescriptorList_t;
 
 /**
- * @brief Initializes a behaviour descriptor for a given task
+ * @brief Allocates the bursts of a task
  *
- * This function initializes a behaviour descriptor of a given task.
+ * This function allocates the arrays of types and durations of the given
+ * number of bursts from an arena.
  *
- * @param desc The descriptor to be initialized.
+ * @param bursts The bursts to be allocated.
+ * @param arena The arena where the arrays are stored.
+ * @param size The number of bursts.
+ *
+ * @return 0 on success, -1 if there is not enough memory.
+ *
+ */
+int allocTaskBursts(TaskBursts_t * bursts, Arena_t * arena, unsigned int size);
+
+/**
+ * @brief Allocates the sectors of the bursts of a task
+ *
+ * This function allocates the array of sectors of some bursts already
+ * allocated with allocTaskBursts(). All the sectors start as 0.
+ *
+ * @param bursts The bursts.
+ * @param arena The arena where the array is stored.
+ *
+ * @return 0 on success, -1 if there is not enough memory.
+ *
+ */
+int allocTaskSectors(TaskBursts_t * bursts, Arena_t * arena);
+
+/**
+ * @brief Returns the sector accessed by a burst of a task
+ *
+ * @param bursts The bursts of the task.
+ * @param index The index of the burst.
+ *
+ * @return The sector of the burst, 0 if the task does not give any.
+ *
+ */
+uint32_t getBurstSector(const TaskBursts_t * bursts, unsigned int index);
+
+/**
+ * @brief Returns the partition of the CPUs a task runs on
+ *
+ * A task pinned to a partition runs on it. A workload may pin its tasks to
+ * more partitions than the simulation has, so the partition wraps around.
+ * Tasks that are not pinned are spread over the partitions by PID.
+ *
+ * @param desc The descriptor of the task.
+ * @param pid The PID of the task.
+ * @param partitions The number of partitions of the simulation.
+ *
+ * @return The index of the partition, from 0 to partitions - 1.
  *
  */
-void initTaskBehaviour(TaskBehaviour_t * behaviour);
+unsigned int getTaskPartition(const TaskDescriptor_t * desc, unsigned int pid,
+                              unsigned int partitions);
 
 /**
  * @brief Initializes a descriptor for a given task
@@ -73,20 +179,31 @@ void initTaskBehaviour(TaskBehaviour_t * behaviour);
 void initTaskDescriptor(TaskDescriptor_t * desc);
 
 /**
- * @brief Appends a behaviour item to an existing list
+ * @brief Resets a descriptor to its pristine state
  *
- * This function appends a new behaviour to an existing list.
+ * This function initializes the PCB of the task with the parsed priority
+ * and rewinds the task to the beginning of its first burst, so that the
+ * same task can be simulated again.
  *
- * @param list The list of behaviours. 
- * @param behaviour The behaviour item to be appended.
+ * @param desc The descriptor to be reset.
  *
  */
-void appendBehaviour(TaskBehaviourList_t * list, TaskBehaviour_t * behaviour);
+void resetTaskDescriptor(TaskDescriptor_t * desc);
+
+/**
+ * @brief Resets all the descriptors of a list to their pristine state
+ *
+ * @param list Pointer to the list.
+ *
+ */
+void resetDescriptors(TaskDescriptorList_t * list);
 
 /**
  * @brief Initializes a task descriptor list
  *
- * This function initializes a task descriptor list.
+ * This function initializes a task descriptor list and its arena. The
+ * descriptors of the list must be allocated from the arena of the list, and
+ * the list starts with the default device table.
  *
  * @param list Pointer to the list to be initialized.
  *
@@ -104,4 +221,48 @@ void initTaskDescriptorList(TaskDescriptorList_t * list);
  */
 void appendDescriptor(TaskDescriptorList_t * list, TaskDescriptor_t * desc);
 
+/**
+ * @brief Moves all the descriptors of a list to the end of another list.
+ *
+ * The descriptors keep their order, and the memory of the other list is
+ * moved into the arena of the list. The other list is left empty. The
+ * descriptors must use the devices of the list.
+ *
+ * @param list Pointer to the list.
+ * @param other Pointer to the list whose descriptors are moved.
+ *
+ */
+void concatDescriptors(TaskDescriptorList_t * list,
+                       TaskDescriptorList_t * other);
+
+/**
+ * @brief Sorts a task descriptor list by start time.
+ *
+ * This function sorts the given list by the start time of its descriptors.
+ * The sort is stable, so descriptors with the same start time keep their
+ * relative order.
+ *
+ * @param list Pointer to the list.
+ *
+ */
+void sortDescriptorsByStartTime(TaskDescriptorList_t * list);
+
+/**
+ * @brief Makes a deep copy of a task descriptor list.
+ *
+ * This function copies every descriptor of a list together with its
+ * bursts and its command into the arena of the copy, along with the device
+ * table, so that the copy can be simulated independently of the original
+ * list. The copy is reset to its pristine state and must be released with
+ * freeDescriptors(), even if the copy fails.
+ *
+ * @param copy Pointer to the list that will store the copy.
+ * @param list Pointer to the list to copy.
+ *
+ * @return 0 on success, -1 if there is not enough memory.
+ *
+ */
+int cloneDescriptors(TaskDescriptorList_t * copy,
+                      const TaskDescriptorList_t * list);
+
 #endif // __DESCRIPTORS_H__
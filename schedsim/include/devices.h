@@ -0,0 +1,261 @@
+#ifndef __DEVICES_H__
+#define __DEVICES_H__
+
+#include <stdint.h>
+
+#include <tasks.h>
+
+/**
+ * Maximum number of devices of a workload. A burst of type n > 0 is served
+ * by device n - 1, and the type of a burst is stored in a byte.
+ */
+#define MAX_DEVICES 16
+
+/** Maximum number of channels of a device */
+#define MAX_CHANNELS 256
+
+/** Size of the name of a device, including the trailing '\0' */
+#define DEVICE_NAME_SIZE 32
+
+/** Ticks a request waits before the deadline discipline serves it first */
+#define DEFAULT_DEADLINE 50
+
+struct device;
+
+/**
+ * Queueing discipline of a device. It decides the order in which the
+ * requests that find every channel of the device busy are served.
+ */
+typedef struct {
+
+    /** Name of the discipline, as given in the workload */
+    const char * name;
+
+    /**
+     * @brief Enqueue function
+     *
+     * This function is called when a task requests the device and all its
+     * channels are busy. The function must add the task to the waiting queue
+     * of the device.
+     *
+     * @param device Pointer to the device.
+     * @param pcb Pointer to the PCB of the task.
+     *
+     */
+    void (* enqueue)(struct device * device, PCB_t * pcb);
+
+    /**
+     * @brief Dequeue function
+     *
+     * This function is called when a channel of the device becomes free. The
+     * function must extract the next task to be served from the waiting
+     * queue of the device.
+     *
+     * @param device Pointer to the device.
+     * @param clock The current tick.
+     *
+     * @return The PCB of the next task or NULL if no task is waiting.
+     *
+     */
+    PCB_t * (* dequeue)(struct device * device, unsigned int clock);
+
+    /**
+     * Non-zero if the discipline orders the tasks by the service they have
+     * received from the device, which the device then keeps
+     */
+    int tracksService;
+
+} DeviceDiscipline_t;
+
+/**
+ * Available queueing disciplines:
+ *
+ * - fifo: arrival order.
+ * - prio: higher priorities first, arrival order among equal ones.
+ * - sstf: the request whose sector is closest to the head first.
+ * - elevator: the head sweeps the sectors up and down, serving the requests
+ *   on its way (LOOK).
+ * - deadline: the head sweeps the sectors upwards and wraps around (C-LOOK),
+ *   but a request that has waited for the deadline of the device is served
+ *   before any other.
+ * - bfq: the task that has received the least service from the device,
+ *   weighted by its priority, first.
+ */
+extern const DeviceDiscipline_t fifoDiscipline;
+extern const DeviceDiscipline_t prioDiscipline;
+extern const DeviceDiscipline_t sstfDiscipline;
+extern const DeviceDiscipline_t elevatorDiscipline;
+extern const DeviceDiscipline_t deadlineDiscipline;
+extern const DeviceDiscipline_t bfqDiscipline;
+
+/**
+ * Declaration of a device in a workload.
+ */
+typedef struct {
+
+    char name[DEVICE_NAME_SIZE];
+
+    /** Number of requests the device serves in parallel */
+    unsigned int channels;
+
+    const DeviceDiscipline_t * discipline;
+
+    /** Deadline of the requests, for the deadline discipline */
+    unsigned int deadline;
+
+    /** Ticks added to a request for every sector the head travels */
+    unsigned int seek;
+
+} DeviceConfig_t;
+
+/**
+ * Devices of a workload, in declaration order.
+ */
+typedef struct {
+
+    unsigned int size;
+    DeviceConfig_t devices[MAX_DEVICES];
+
+    /**
+     * Non-zero if the workload does not declare its devices. The default
+     * devices are then shown as the simulator always did: the keyboard
+     * before the hard disk, with the original column names
+     */
+    int implicit;
+
+} DeviceTable_t;
+
+/**
+ * Channel of a device, which serves a single request at a time.
+ */
+typedef struct {
+
+    /** Pointer to the task that is currently using the channel */
+    PCB_t * task;
+
+    /**
+     * Tick in which the task started to use the channel. The channel does
+     * not serve the task until the next tick
+     */
+    unsigned int start;
+
+    /**
+     * PID of the task using the channel in the last binary trace event. PIDs
+     * are used instead of pointers because the memory of a finished task may
+     * be reused by a new one.
+     */
+    unsigned int tracedPID;
+
+} DeviceChannel_t;
+
+/**
+ * Service a task has received from a device.
+ */
+typedef struct {
+
+    /** The task, or NULL if the slot is free */
+    PCB_t * pcb;
+
+    /** Ticks of service, including the seeks of the requests */
+    unsigned long ticks;
+
+} DeviceService_t;
+
+/**
+ * State of a simulated device.
+ */
+typedef struct device {
+
+    const char * name;
+
+    /** Index of the device, which serves the bursts of type index + 1 */
+    unsigned int index;
+
+    const DeviceDiscipline_t * discipline;
+
+    /** The channels, channelCount of them */
+    DeviceChannel_t * channels;
+    unsigned int channelCount;
+
+    /** Number of channels that are serving a task */
+    unsigned int busyChannels;
+
+    /** Queue of the tasks waiting for a free channel */
+    TaskQueue_t waitingQueue;
+
+    /** Deadline of the requests, for the deadline discipline */
+    unsigned int deadline;
+
+    /** Ticks added to a request for every sector the head travels */
+    unsigned int seek;
+
+    /** Sector of the last request the device started to serve */
+    uint32_t head;
+
+    /** Non-zero while the elevator sweeps the sectors downwards */
+    int descending;
+
+    /**
+     * Service received by the living tasks that have used the device, for
+     * the disciplines that track it. Open addressing table keyed by the
+     * PCB, serviceCapacity slots, allocated on the first request
+     */
+    DeviceService_t * services;
+    unsigned int serviceCount;
+    unsigned int serviceCapacity;
+
+    /** Number of ticks in which a channel has been busy, over all of them */
+    unsigned long busyTicks;
+
+} Device_t;
+
+/**
+ * @brief Initializes a device table with the default devices
+ *
+ * Workloads that do not declare their devices have a hard disk and a
+ * keyboard, served by bursts of type 1 and 2 respectively. Both of them
+ * have a single channel and serve their requests in FIFO order.
+ *
+ * @param table Pointer to the table.
+ *
+ */
+void initDeviceTable(DeviceTable_t * table);
+
+/**
+ * @brief Adds service to the account of a task on a device
+ *
+ * Nothing is stored unless the discipline of the device tracks the service.
+ *
+ * @param device Pointer to the device.
+ * @param pcb Pointer to the PCB of the task.
+ * @param ticks Ticks of service the task is about to receive.
+ *
+ * @return 0 on success, -1 if there is not enough memory.
+ *
+ */
+int addDeviceService(Device_t * device, PCB_t * pcb, unsigned long ticks);
+
+/**
+ * @brief Drops the account of a task on a device
+ *
+ * It must be called when the task leaves the system, since its memory may
+ * be reused by a new task.
+ *
+ * @param device Pointer to the device.
+ * @param pcb Pointer to the PCB of the task.
+ *
+ */
+void forgetDeviceService(Device_t * device, PCB_t * pcb);
+
+/**
+ * @brief Finds a queueing discipline by its name
+ *
+ * @param name Name of the discipline.
+ *
+ * @return Pointer to the discipline or NULL if there is no discipline with
+ * that name.
+ *
+ */
+const DeviceDiscipline_t * findDiscipline(const char * name);
+
+#endif // __DEVICES_H__
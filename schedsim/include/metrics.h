@@ -0,0 +1,232 @@
+#ifndef __METRICS_H__
+#define __METRICS_H__
+
+#include <tasks.h>
+#include <trace.h>
+#include <devices.h>
+
+/** Maximum number of levels of a multilevel scheduling policy */
+#define MAX_LEVELS 16
+
+typedef enum {
+
+    METRIC_TURNAROUND = 0,
+    METRIC_RESPONSE = 1,
+    METRIC_READY_WAIT = 2,
+    METRIC_IO_WAIT = 3,
+    METRIC_SWITCHES = 4,
+    METRIC_PREEMPTIONS = 5,
+    METRICS = 6
+
+} Metric_t;
+
+/**
+ * Scheduling counters of a task. They are updated incrementally on every
+ * state transition of the task.
+ */
+typedef struct {
+
+    unsigned int arrival;
+    unsigned int firstDispatch;
+    unsigned int completion;
+    unsigned int lastTransition;
+
+    unsigned int readyWait;
+    unsigned int ioWait;
+    unsigned int contextSwitches;
+    unsigned int preemptions;
+
+    int dispatched;
+
+} TaskMetrics_t;
+
+/**
+ * Aggregate statistics of a metric over all the finished tasks.
+ */
+typedef struct {
+
+    double mean;
+    unsigned int p50;
+    unsigned int p95;
+    unsigned int p99;
+    unsigned int max;
+
+} MetricStats_t;
+
+typedef struct {
+
+    unsigned int tasks;
+    MetricStats_t stats[METRICS];
+
+    /** Number of requests served by every device */
+    unsigned int requests[MAX_DEVICES];
+
+    /** I/O latency of the requests of every device */
+    MetricStats_t latency[MAX_DEVICES];
+
+    /** Number of dispatches from every level of a multilevel policy */
+    unsigned int dispatches[MAX_LEVELS];
+
+    /** Ready wait of the tasks dispatched from every level */
+    MetricStats_t levelWait[MAX_LEVELS];
+
+} MetricsSummary_t;
+
+/**
+ * Latencies of the requests served by a device, or waits of the tasks
+ * dispatched from a level.
+ */
+typedef struct {
+
+    unsigned int * latencies;
+    unsigned int count;
+    unsigned int capacity;
+
+} LatencySamples_t;
+
+/**
+ * Results of the finished tasks of a simulation, one array per metric,
+ * latencies of the requests served by every device and waits of the tasks
+ * dispatched from every level of a multilevel policy.
+ */
+typedef struct {
+
+    unsigned int * results[METRICS];
+    unsigned int count;
+    unsigned int capacity;
+
+    LatencySamples_t devices[MAX_DEVICES];
+
+    LatencySamples_t levels[MAX_LEVELS];
+
+    /**
+     * Non-zero once a result could not be stored for lack of memory. The
+     * results are then incomplete
+     */
+    int failed;
+
+} MetricsCollector_t;
+
+/**
+ * @brief Resets a metrics collector.
+ *
+ * This function discards the results of all the finished tasks, clears
+ * the failure of the collector and makes sure the collector is registered as the state listener of the
+ * tasks. The listener finds the collector of a task through the simulator
+ * the task belongs to.
+ *
+ * @param metrics Pointer to the collector.
+ */
+void resetMetrics(MetricsCollector_t * metrics);
+
+/**
+ * @brief Stores the latency of a request served by a device.
+ *
+ * The collector is marked as failed if there is not enough memory.
+ *
+ * @param metrics Pointer to the collector.
+ * @param device Index of the device.
+ * @param latency Ticks from the request to the end of its I/O burst.
+ */
+void recordLatency(MetricsCollector_t * metrics, unsigned int device,
+                   unsigned int latency);
+
+/**
+ * @brief Stores the ready wait of a task dispatched from a level.
+ *
+ * The collector is marked as failed if there is not enough memory.
+ *
+ * @param metrics Pointer to the collector.
+ * @param level Index of the level.
+ * @param wait Ticks the task waited on the ready queue.
+ */
+void recordLevelWait(MetricsCollector_t * metrics, unsigned int level,
+                     unsigned int wait);
+
+/**
+ * @brief Adds the results of a collector to another one.
+ *
+ * The receiving collector is marked as failed if there is not enough
+ * memory.
+ *
+ * @param metrics Pointer to the collector that receives the results.
+ * @param other Pointer to the collector whose results are added.
+ */
+void mergeMetrics(MetricsCollector_t * metrics, MetricsCollector_t * other);
+
+/**
+ * @brief Computes the aggregate statistics of the finished tasks.
+ *
+ * @param metrics Pointer to the collector.
+ * @param summary Pointer to the structure that will store the statistics.
+ * @return 0 on success, -1 if there is not enough memory.
+ */
+int summarizeMetrics(MetricsCollector_t * metrics, MetricsSummary_t * summary);
+
+/**
+ * @brief Prints the aggregate statistics of the finished tasks.
+ *
+ * @param metrics Pointer to the collector.
+ * @param trace Trace where the statistics are printed.
+ * @return 0 on success, -1 if there is not enough memory.
+ */
+int printMetrics(MetricsCollector_t * metrics, Trace_t * trace);
+
+/**
+ * @brief Prints the I/O latency statistics of the devices.
+ *
+ * @param metrics Pointer to the collector.
+ * @param devices The devices of the simulation.
+ * @param count Number of devices.
+ * @param trace Trace where the statistics are printed.
+ * @return 0 on success, -1 if there is not enough memory.
+ */
+int printLatencies(MetricsCollector_t * metrics, const Device_t * devices,
+                   unsigned int count, Trace_t * trace);
+
+/**
+ * @brief Prints the statistics of the levels of a multilevel policy.
+ *
+ * The mean length of the ready queue of a level is the time its tasks have
+ * waited over the simulated ticks. Nothing is printed if no task has been
+ * dispatched from any level.
+ *
+ * @param metrics Pointer to the collector.
+ * @param ticks Number of simulated ticks.
+ * @param trace Trace where the statistics are printed.
+ * @return 0 on success, -1 if there is not enough memory.
+ */
+int printLevels(MetricsCollector_t * metrics, unsigned int ticks,
+                Trace_t * trace);
+
+/**
+ * @brief Prints the aggregate statistics of several runs side by side.
+ *
+ * @param trace Trace where the statistics are printed.
+ * @param names Names of the runs.
+ * @param summaries Statistics of every run.
+ * @param ticks Number of ticks simulated on every run.
+ * @param count Number of runs.
+ */
+void printMetricsComparison(Trace_t * trace, const char * const * names,
+                            const MetricsSummary_t * summaries,
+                            const unsigned int * ticks, unsigned int count);
+
+/**
+ * @brief Releases the memory used by a metrics collector.
+ *
+ * @param metrics Pointer to the collector.
+ */
+void freeMetrics(MetricsCollector_t * metrics);
+
+/**
+ * @brief Returns the name of a metric.
+ */
+const char * getMetricName(Metric_t metric);
+
+/**
+ * @brief Returns the short lowercase name of a metric, e.g. for CSV headers.
+ */
+const char * getMetricKey(Metric_t metric);
+
+#endif // __METRICS_H__
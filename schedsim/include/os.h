@@ -3,55 +3,157 @@
 
 #include <tasks.h>
 
+/**
+ * State of a simulation, see simulator.h. Schedulers only reach it through
+ * the functions of this file.
+ */
+typedef struct simulator Simulator_t;
+
 /**
  * @brief Dispatches a task.
  *
- * This function dispatches a task to execution.
+ * This function dispatches a task to execution on a given CPU.
  *
+ * @param sim Pointer to the simulator.
+ * @param cpu The CPU.
  * @param pcb Pointer to the PCB to dispatch.
  */
-void dispatch(PCB_t * pcb);
+void dispatch(Simulator_t * sim, unsigned int cpu, PCB_t * pcb);
+
+/**
+ * @brief Returns the current value of the clock
+ *
+ * @param sim Pointer to the simulator.
+ *
+ * @return Number of ticks since the beginning of the simulation.
+ */
+unsigned int getClock(Simulator_t * sim);
+
+/**
+ * @brief Returns the number of CPUs of the simulated system
+ *
+ * @param sim Pointer to the simulator.
+ *
+ * @return The number of CPUs.
+ */
+unsigned int getCpuCount(Simulator_t * sim);
 
 /**
- * @brief Programs a hard disk operation on behalf of a given task.
+ * @brief Returns the current running task of a CPU
  *
- * This function simulates the programming of a hard disk operation on behalf
- * of a given task.
+ * @param sim Pointer to the simulator.
+ * @param cpu The CPU.
  *
+ * @return Pointer to the PCB of the running task.
+ */
+PCB_t * getRunningTask(Simulator_t * sim, unsigned int cpu);
+
+/**
+ * @brief Returns the quantum of the round robin policy
+ *
+ * @param sim Pointer to the simulator.
+ *
+ * @return Number of ticks of a quantum.
+ */
+unsigned int getQuantum(Simulator_t * sim);
+
+/**
+ * @brief Returns the quantum of a task for the round robin policy
+ *
+ * @param sim Pointer to the simulator.
  * @param pcb Pointer to the PCB of the task.
+ *
+ * @return The quantum given in the descriptor of the task, or the quantum
+ * of the simulation if the descriptor does not give any.
  */
-void programHardDisk(PCB_t * pcb);
+unsigned int getTaskQuantum(Simulator_t * sim, PCB_t * pcb);
 
 /**
- * @brief Programs a keyboard operation on behalf of a given task.
+ * @brief Returns the remaining time of the current burst of a task
  *
- * This function simulates the programming of a keyboard waiting operation on behalf
- * of a given task.
+ * A real scheduler cannot know it in advance. It is only meant for the
+ * policies that give a reference lower bound, such as shortest job first.
  *
+ * @param sim Pointer to the simulator.
  * @param pcb Pointer to the PCB of the task.
+ *
+ * @return Number of ticks left of the current burst of the task.
  */
-void programKeyboard(PCB_t * pcb);
+unsigned int getBurstRemaining(Simulator_t * sim, PCB_t * pcb);
 
+/**
+ * @brief Returns the tick in which the running task of a CPU was dispatched
+ *
+ * @param sim Pointer to the simulator.
+ * @param cpu The CPU.
+ *
+ * @return The value of the clock when dispatch() was last called on the CPU.
+ */
+unsigned int getDispatchTime(Simulator_t * sim, unsigned int cpu);
 
 /**
- * @brief Returns the current running task
+ * @brief Returns the aging interval of the priority policy
  *
- * @return Pointer to the PCB of the running task.
+ * @param sim Pointer to the simulator.
+ *
+ * @return Number of ticks a ready task waits before its priority is raised
+ * by one, or 0 if aging is disabled.
  */
-PCB_t * getRunningTask();
+unsigned int getAging(Simulator_t * sim);
 
 /**
- * @brief Returns the current hard disk waiting task
+ * @brief Returns the priority a task was given in its descriptor
+ *
+ * The priority of the PCB may differ from it if the scheduler changes it,
+ * e.g. when the task ages.
+ *
+ * @param sim Pointer to the simulator.
+ * @param pcb Pointer to the PCB of the task.
+ *
+ * @return The priority of the descriptor of the task.
+ */
+unsigned int getBasePriority(Simulator_t * sim, PCB_t * pcb);
+
+/**
+ * @brief Returns the number of levels of the multilevel feedback queue
+ *
+ * @param sim Pointer to the simulator.
  *
- * @return Pointer to the PCB of the waiting task.
+ * @return The number of levels, between 1 and MAX_LEVELS.
  */
-PCB_t * getHardDiskWaitingTask();
+unsigned int getLevels(Simulator_t * sim);
 
 /**
- * @brief Returns the current keyboard waiting task
+ * @brief Returns the interval of the priority boost of the multilevel
+ * feedback queue
+ *
+ * @param sim Pointer to the simulator.
+ *
+ * @return Number of ticks between two boosts, or 0 if there is no boost.
+ */
+unsigned int getBoost(Simulator_t * sim);
+
+/**
+ * @brief Records that a task is dispatched from a level of a multilevel
+ * policy
+ *
+ * It must be called before the task leaves the READY state. The time the
+ * task has waited on the ready queue is accounted to the level.
+ *
+ * @param sim Pointer to the simulator.
+ * @param level The level, lower than MAX_LEVELS.
+ * @param pcb Pointer to the PCB of the task.
+ */
+void recordLevelDispatch(Simulator_t * sim, unsigned int level, PCB_t * pcb);
+
+/**
+ * @brief Returns the ready queue of a CPU
+ *
+ * @param sim Pointer to the simulator.
+ * @param cpu The CPU.
  *
- * @return Pointer to the PCB of the waiting task.
+ * @return Pointer to the ready queue.
  */
-PCB_t * getKeyboardWaitingTask();
+TaskQueue_t * getReadyQueue(Simulator_t * sim, unsigned int cpu);
 
 #endif // __OS_H__
@@ -1,29 +1,126 @@
 #ifndef __PARSER_H__
 #define __PARSER_H__
 
+#include <stddef.h>
+
+#include <lib/jsmn.h>
+
 #include <descriptors.h>
+#include <source.h>
+
+/**
+ * Source that parses the tasks of a descriptor file one by one, as the
+ * simulation reaches their start time. The tasks must be sorted by start
+ * time in the file. Every task is freed as soon as it finishes, so the
+ * memory used is bounded by the number of living tasks.
+ */
+typedef struct {
+
+    TaskSource_t source;
+
+    /** Contents of the mapped file */
+    char *descriptors;
+    size_t size;
+
+    /** Position of the next task in the file */
+    size_t pos;
+
+    /** Bytes at the beginning of the file already returned to the kernel */
+    size_t released;
+
+    /** Non-zero if "tasks" is a single object instead of an array */
+    int single;
+
+    /** Non-zero once the last task has been parsed */
+    int done;
+
+    /**
+     * Non-zero if a task or the end of the file is malformed. The source
+     * then ends early, as if there were no more tasks.
+     */
+    int failed;
+
+    /** Devices declared in the header of the file */
+    DeviceTable_t devices;
+
+    unsigned int tasks;
+    unsigned int lastStartTime;
+
+    /** Token buffer, reused for every task */
+    jsmntok_t *tokens;
+    unsigned int capacity;
+
+} StreamSource_t;
 
 /**
  * @brief Parse a descriptor file
  *
  * This function parses a JSON file that contains a list of task descriptors.
+ * The file may declare its devices in a "devices" array before the tasks,
+ * which replaces the device table of the list.
  *
  * @param list Pointer to the list that will store the parsed descriptors.
  * @param fd File descriptor of the opened JSON file.
  *
+ * @return 0 on success, -1 if the file is malformed, after printing the
+ * reason on stderr. On error, the list may hold some of the descriptors
+ * and must still be released with freeDescriptors().
+ *
  */
-void parseDescriptors(TaskDescriptorList_t * list, int fd);
+int parseDescriptors(TaskDescriptorList_t * list, int fd);
 
 
+/**
+ * @brief Parses a descriptor file on several threads
+ *
+ * This function finds the boundaries of the tasks of the file, splits them
+ * in chunks of similar size and parses every chunk on its own thread. The
+ * descriptors are appended to the list in the order of the file. Small
+ * files are parsed by parseDescriptors() on the calling thread.
+ *
+ * @param list Pointer to the list of descriptors.
+ * @param fd File descriptor of the opened JSON file.
+ * @param threads Maximum number of threads.
+ *
+ * @return 0 on success, -1 on error, as parseDescriptors().
+ *
+ */
+int parseDescriptorsParallel(TaskDescriptorList_t * list, int fd,
+                              unsigned int threads);
+
 /**
  * @brief Frees the dynamic memory allocated during the parsing
  *
  * This function frees all the memory that was dynamically allocated when
- * the parsing process was performed.
+ * the parsing process was performed. All of it belongs to the arena of the
+ * list, so it is released at once.
  *
  * @param list Pointer to the list of descriptors.
  *
  */
 void freeDescriptors(TaskDescriptorList_t * list);
 
+/**
+ * @brief Opens a streaming source over a descriptor file
+ *
+ * This function maps the file and checks its header. The tasks are parsed
+ * later, one at a time, when the simulator pulls them.
+ *
+ * @param stream Pointer to the source.
+ * @param fd File descriptor of the opened JSON file.
+ *
+ * @return 0 on success, -1 if the file cannot be mapped or its header is
+ * malformed. The source must not be closed if it could not be opened.
+ *
+ */
+int openStreamSource(StreamSource_t * stream, int fd);
+
+/**
+ * @brief Closes a streaming source
+ *
+ * @param stream Pointer to the source.
+ *
+ */
+void closeStreamSource(StreamSource_t * stream);
+
 #endif // __PARSER_H__
@@ -0,0 +1,40 @@
+#ifndef __PARTITION_H__
+#define __PARTITION_H__
+
+#include <simulator.h>
+#include <source.h>
+
+/** Maximum number of tasks handed to the partitions in a single window */
+#define PARTITION_FEED 4096
+
+/**
+ * Minimum length in ticks of a window simulated by several threads. Shorter
+ * windows, which are the norm when the devices are contended, are run by
+ * the main thread alone, since waking the workers would cost more than
+ * simulating the window.
+ */
+#define PARALLEL_WINDOW 16
+
+/**
+ * @brief Runs the simulation of a source with the parallel engine.
+ *
+ * Every partition of the CPUs is simulated by its own simulator, and the
+ * partitions are spread over options.threads threads. The partitions only
+ * interact through the devices, so they run independently within time
+ * windows in which no device can interrupt them. At the end of every window
+ * the requests of all the partitions are applied to the devices in the
+ * same order as the sequential engines would do, so the results are exactly
+ * the same.
+ *
+ * Only the summary and the metrics of the simulation are produced: the
+ * state of the whole system is never built on any single tick.
+ *
+ * @param sim Pointer to the simulator.
+ * @param source Pointer to the source of the tasks.
+ *
+ * @return 0 on success, -1 if the simulation stopped because it ran out of
+ * memory.
+ */
+int runPartitions(Simulator_t * sim, TaskSource_t * source);
+
+#endif // __PARTITION_H__
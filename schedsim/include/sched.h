@@ -2,100 +2,173 @@
 #define __SCHED_H__
 
 #include <tasks.h>
+#include <os.h>
 
 /**
- * @brief Scheduling function
- *
- * This function must select the next task to be executed. The selected task
- * must be extracted from the ready queue.
- *
- * @return The PCB of the next task to be executed.
- *
+ * Scheduling policy. Every policy implements the following set of functions,
+ * which are called by the simulator on the corresponding events.
  */
-PCB_t * schedule();
+typedef struct {
 
-/**
- * @brief Start Task function
- *
- * This function is executed every time a new task enters in the system. The
- * function must incorporate the new task into the scheduling system.
- *
- * @param pcb Pointer to the PCB corresponding to the new task.
- *
- */
-void startTask(PCB_t * pcb);
+    /** Name of the policy, as given on the command line */
+    const char * name;
 
-/**
- * @brief Exit Task function
- *
- * This function is exectued every time a task is terminated. The function
- * must eliminate the task from the scheduling system.
- *
- * @param pcb Pointer to the PCB corresponding to the terminated task.
- *
- */
-void exitTask(PCB_t * pcb);
+    /**
+     * @brief Scheduling function
+     *
+     * This function must select the next task to be executed on a CPU. The
+     * selected task must be extracted from the ready queue of that CPU.
+     *
+     * @param sim Pointer to the simulator.
+     * @param cpu The CPU that must be given a task.
+     *
+     * @return The PCB of the next task to be executed.
+     *
+     */
+    PCB_t * (* schedule)(Simulator_t * sim, unsigned int cpu);
 
-/**
- * @brief Clock Tick function
- *
- * This function is executed with every clock tick. The function receives
- * a pointer to the PCB of the task that is currently being executed on the
- * CPU. If no task is currently being executed, or if the task that was being
- * executed ended its burst before the clock tick, then the function shall
- * receive a NULL pointer.
- *
- * @param pcb Pointer to the PCB corresponding to the task that is currently
- * being executed on the CPU or NULL if no task is currently in execution.
- *
- */
-void clockTick(PCB_t * pcb);
+    /**
+     * @brief Start Task function
+     *
+     * This function is executed every time a new task enters in the system. The
+     * function must incorporate the new task into the scheduling system. The
+     * simulator places every new task on the least loaded CPU.
+     *
+     * @param sim Pointer to the simulator.
+     * @param cpu The CPU where the new task is placed.
+     * @param pcb Pointer to the PCB corresponding to the new task.
+     *
+     */
+    void (* startTask)(Simulator_t * sim, unsigned int cpu, PCB_t * pcb);
 
-/**
- * @brief Yield for Hard Disk function
- *
- * This function is called when a task wants to access the Hard Disk.
- * If there was a previous task using the HD, then the new task should
- * be appended to the Hard Disk waiting queue until the current operation
- * is finished.
- *
- * @param pcb Pointer to the PCB that wants to the access the HD.
- *
- */
-void yieldHardDisk(PCB_t * pcb);
+    /**
+     * @brief Exit Task function
+     *
+     * This function is exectued every time a task is terminated. The function
+     * must eliminate the task from the scheduling system. A task whose last
+     * burst is an I/O burst terminates while other tasks may be running on
+     * its CPU, which must then be left alone.
+     *
+     * @param sim Pointer to the simulator.
+     * @param cpu The CPU where the task was running or last ran.
+     * @param pcb Pointer to the PCB corresponding to the terminated task.
+     *
+     */
+    void (* exitTask)(Simulator_t * sim, unsigned int cpu, PCB_t * pcb);
 
-/**
- * @brief Hard Disk Interrupt function
- *
- * This function is called whenever a Hard Disk interrupt occurs. The function
- * shall check if there was any other task waiting to access the HD and then
- * include the new task for scheduling.
- *
- */ 
-void ioHardDiskIRQ(PCB_t * pcb);
+    /**
+     * @brief Clock Tick function
+     *
+     * This function is executed with every clock tick. The function receives
+     * a pointer to the PCB of the task that is currently being executed on the
+     * CPU. If no task is currently being executed, or if the task that was being
+     * executed ended its burst before the clock tick, then the function shall
+     * receive a NULL pointer.
+     *
+     * @param sim Pointer to the simulator.
+     * @param cpu The CPU whose clock ticked.
+     * @param pcb Pointer to the PCB corresponding to the task that is currently
+     * being executed on the CPU or NULL if no task is currently in execution.
+     *
+     */
+    void (* clockTick)(Simulator_t * sim, unsigned int cpu, PCB_t * pcb);
+
+    /**
+     * @brief Next Clock Event function
+     *
+     * This function is used by the event-driven engine. It must return the
+     * number of consecutive calls to clockTick() with the given PCB after which
+     * the scheduler will act, i.e. preempt the task or modify any queue. If the
+     * scheduler never acts on a clock tick, it shall return UINT_MAX.
+     *
+     * @param sim Pointer to the simulator.
+     * @param cpu The CPU whose clock is checked.
+     * @param pcb Pointer to the PCB corresponding to the task that is currently
+     * being executed on the CPU or NULL if no task is currently in execution.
+     *
+     * @return The number of ticks until the scheduler acts.
+     *
+     */
+    unsigned int (* nextClockEvent)(Simulator_t * sim, unsigned int cpu,
+                                     PCB_t * pcb);
+
+    /**
+     * @brief Yield for Device function
+     *
+     * This function is called when a task leaves a CPU to wait for a device.
+     * Right after it returns, the simulator hands the task to the device,
+     * which serves it on a free channel or queues it according to its own
+     * discipline. The function must select another task for the CPU.
+     *
+     * @param sim Pointer to the simulator.
+     * @param cpu The CPU the task is leaving.
+     * @param device Index of the device the task waits for.
+     * @param pcb Pointer to the PCB that wants to access the device.
+     *
+     */
+    void (* yieldDevice)(Simulator_t * sim, unsigned int cpu,
+                         unsigned int device, PCB_t * pcb);
+
+    /**
+     * @brief Device Interrupt function
+     *
+     * This function is called whenever a device finishes the I/O burst of a
+     * task whose next burst is a CPU burst. The device has already started
+     * serving the next waiting task, so the function only has to include
+     * the task for scheduling.
+     *
+     * @param sim Pointer to the simulator.
+     * @param cpu The CPU where the task last ran.
+     * @param device Index of the device that served the task.
+     * @param pcb Pointer to the PCB of the task whose operation has finished.
+     *
+     */
+    void (* ioDeviceIRQ)(Simulator_t * sim, unsigned int cpu,
+                         unsigned int device, PCB_t * pcb);
+
+    /**
+     * @brief Migrate Task function
+     *
+     * This function is called by the load balancer when it moves a ready task
+     * to another CPU. The task has already been extracted from the ready queue
+     * of its previous CPU and is still in ready state. The function must
+     * incorporate the task into the scheduling system of the new CPU.
+     *
+     * @param sim Pointer to the simulator.
+     * @param cpu The CPU the task is moved to.
+     * @param pcb Pointer to the PCB of the migrated task.
+     *
+     */
+    void (* migrateTask)(Simulator_t * sim, unsigned int cpu, PCB_t * pcb);
+
+} SchedPolicy_t;
+
+/** Available scheduling policies */
+extern const SchedPolicy_t fifoPolicy;
+extern const SchedPolicy_t rrPolicy;
+extern const SchedPolicy_t prioPolicy;
+extern const SchedPolicy_t mlfqPolicy;
+extern const SchedPolicy_t cfsPolicy;
+extern const SchedPolicy_t sjfPolicy;
+extern const SchedPolicy_t srtfPolicy;
+extern const SchedPolicy_t sjfExpPolicy;
 
 /**
- * @brief Yield for Keyboard function
- 
- * This function is called when a task wants to wait for a keypress on the
- * keyboard.  If there was a previous task waiting for the keyboard, then the
- * new task should be appended to the Keyboard waiting queue until the current
- * operation is finished.
+ * @brief Finds a scheduling policy by its name
+ *
+ * @param name Name of the policy.
  *
- * @param pcb Pointer to the PCB that wants to the access the keyboard.
+ * @return Pointer to the policy or NULL if there is no policy with that name.
  *
  */
-void yieldKeyboard(PCB_t * pcb);
+const SchedPolicy_t * findPolicy(const char * name);
 
 /**
- * @brief Keyboard Interrupt function
+ * @brief Returns the list of available scheduling policies
  *
- * This function is called whenever a Keyboard interrupt occurs. The function
- * shall check if there was any other task waiting for the keyboard and then
- * include the new task for scheduling.
+ * @return NULL-terminated array of pointers to the policies.
  *
- */ 
-void ioKeyboardIRQ(PCB_t * pcb);
-
+ */
+const SchedPolicy_t * const * getPolicies();
 
 #endif // __SCHED_H__
@@ -0,0 +1,194 @@
+#ifndef __SCHEDSIM_H__
+#define __SCHEDSIM_H__
+
+#include <metrics.h>
+
+/**
+ * Public interface of libschedsim.
+ *
+ * Every simulation is reached through an opaque handle that owns its
+ * workload, its knobs and its results. Different handles do not share any
+ * state, so they can be used concurrently from different threads. A single
+ * handle must not be used by several threads at the same time.
+ */
+typedef struct schedsim Schedsim_t;
+
+/**
+ * @brief Creates a simulation handle
+ *
+ * The handle starts with an empty workload and the default knobs: the
+ * first available policy, the tick engine and the default quantum.
+ *
+ * @return The new handle or NULL if there is not enough memory.
+ */
+Schedsim_t * schedsimCreate();
+
+/**
+ * @brief Creates a copy of a simulation handle
+ *
+ * The copy gets its own copy of the workload and the same knobs, but none
+ * of the results. It is meant for running what-if variations of a workload
+ * that is parsed only once.
+ *
+ * @param handle The handle to copy.
+ *
+ * @return The new handle or NULL if there is not enough memory.
+ */
+Schedsim_t * schedsimClone(const Schedsim_t * handle);
+
+/**
+ * @brief Releases a simulation handle and everything it owns
+ *
+ * @param handle The handle.
+ */
+void schedsimDestroy(Schedsim_t * handle);
+
+/**
+ * @brief Loads the workload of a simulation from a JSON descriptor file or a
+ * binary workload
+ *
+ * The previous workload of the handle, if any, is discarded. If the file is
+ * malformed, the reason is printed on stderr and the handle is left without
+ * any workload.
+ *
+ * @param handle The handle.
+ * @param path Path of the descriptor file.
+ *
+ * @return 0 on success, -1 if the file cannot be opened or loaded.
+ */
+int schedsimLoadFile(Schedsim_t * handle, const char * path);
+
+/**
+ * @brief Selects the scheduling policy
+ *
+ * @param handle The handle.
+ * @param name Name of the policy, e.g. "fifo".
+ *
+ * @return 0 on success, -1 if there is no policy with that name.
+ */
+int schedsimSetPolicy(Schedsim_t * handle, const char * name);
+
+/**
+ * @brief Selects the simulation engine
+ *
+ * @param handle The handle.
+ * @param name Name of the engine: "tick", "event" or "parallel".
+ *
+ * @return 0 on success, -1 if there is no engine with that name.
+ */
+int schedsimSetEngine(Schedsim_t * handle, const char * name);
+
+/**
+ * @brief Sets the quantum of the round robin policy
+ *
+ * @param handle The handle.
+ * @param quantum Number of ticks of a quantum, at least 1.
+ *
+ * @return 0 on success, -1 if the quantum is not valid.
+ */
+int schedsimSetQuantum(Schedsim_t * handle, unsigned int quantum);
+
+/**
+ * @brief Sets the aging interval of the priority policy
+ *
+ * @param handle The handle.
+ * @param aging Number of ticks a ready task waits before its priority is
+ * raised by one, 0 to disable aging.
+ *
+ * @return 0 on success.
+ */
+int schedsimSetAging(Schedsim_t * handle, unsigned int aging);
+
+/**
+ * @brief Sets the number of levels of the multilevel feedback queue policy
+ *
+ * @param handle The handle.
+ * @param levels Number of levels, between 1 and 16.
+ *
+ * @return 0 on success, -1 if the number of levels is not valid.
+ */
+int schedsimSetLevels(Schedsim_t * handle, unsigned int levels);
+
+/**
+ * @brief Sets the interval of the priority boost of the multilevel feedback
+ * queue policy
+ *
+ * @param handle The handle.
+ * @param boost Number of ticks between two boosts, 0 to disable the boost.
+ *
+ * @return 0 on success.
+ */
+int schedsimSetBoost(Schedsim_t * handle, unsigned int boost);
+
+/**
+ * @brief Sets the number of simulated CPUs
+ *
+ * @param handle The handle.
+ * @param cpus Number of CPUs, between 1 and 128. It must be a multiple of
+ * the number of partitions.
+ *
+ * @return 0 on success, -1 if the number of CPUs is not valid.
+ */
+int schedsimSetCpus(Schedsim_t * handle, unsigned int cpus);
+
+/**
+ * @brief Selects the load balancer of the CPUs
+ *
+ * @param handle The handle.
+ * @param name Name of the balancer: "none", "push" or "steal".
+ *
+ * @return 0 on success, -1 if there is no balancer with that name.
+ */
+int schedsimSetBalancer(Schedsim_t * handle, const char * name);
+
+/**
+ * @brief Splits the CPUs into partitions
+ *
+ * Every task is pinned to a partition and never leaves it. The parallel
+ * engine simulates every partition on its own thread.
+ *
+ * @param handle The handle.
+ * @param partitions Number of partitions. It must divide the number of CPUs.
+ * @param threads Number of threads of the parallel engine, at least 1.
+ *
+ * @return 0 on success, -1 if the partitions or the threads are not valid.
+ */
+int schedsimSetPartitions(Schedsim_t * handle, unsigned int partitions,
+                          unsigned int threads);
+
+/**
+ * @brief Simulates the workload with the current knobs
+ *
+ * The workload is reset before the simulation, so a handle can be run as
+ * many times as needed. The results of the previous run are discarded.
+ *
+ * @param handle The handle.
+ * @return 0 on success, -1 if the simulation ran out of memory. The reason
+ * is printed on stderr and the results of the run are incomplete.
+ */
+int schedsimRun(Schedsim_t * handle);
+
+/**
+ * @brief Returns the number of ticks of the last run
+ *
+ * @param handle The handle.
+ */
+unsigned int schedsimGetTicks(const Schedsim_t * handle);
+
+/**
+ * @brief Returns the number of tasks that did not finish in the last run
+ *
+ * @param handle The handle.
+ */
+unsigned int schedsimGetUnfinished(const Schedsim_t * handle);
+
+/**
+ * @brief Computes the aggregate metrics of the last run
+ *
+ * @param handle The handle.
+ * @param summary Pointer to the structure that will store the metrics.
+ * @return 0 on success, -1 if there is not enough memory.
+ */
+int schedsimGetMetrics(Schedsim_t * handle, MetricsSummary_t * summary);
+
+#endif // __SCHEDSIM_H__
@@ -0,0 +1,350 @@
+#ifndef __SIMULATOR_H__
+#define __SIMULATOR_H__
+
+#include <tasks.h>
+#include <os.h>
+#include <descriptors.h>
+#include <sched.h>
+#include <trace.h>
+#include <metrics.h>
+#include <source.h>
+#include <devices.h>
+
+typedef enum {
+
+    TICK_ENGINE = 0,
+    EVENT_ENGINE = 1,
+    /** Simulates every partition of the CPUs on its own thread */
+    PARALLEL_ENGINE = 2
+
+} Engine_t;
+
+/** Default quantum of the round robin policy, in ticks */
+#define DEFAULT_QUANTUM 2
+
+/** Default number of levels of the multilevel feedback queue policy */
+#define DEFAULT_LEVELS 3
+
+/** Maximum number of simulated CPUs */
+#define MAX_CPUS 128
+
+/**
+ * Load balancers. After every tick, the balancer moves ready tasks between
+ * the run queues of the CPUs.
+ */
+typedef enum {
+
+    /** Tasks stay on the CPU where they were placed */
+    BALANCE_NONE = 0,
+    /** The busiest CPU pushes tasks to the least loaded one */
+    BALANCE_PUSH = 1,
+    /** Idle CPUs steal a task from the longest ready queue */
+    BALANCE_STEAL = 2
+
+} Balancer_t;
+
+/**
+ * Knobs of a simulation.
+ */
+typedef struct {
+
+    const SchedPolicy_t * policy;
+    Engine_t engine;
+    unsigned int quantum;
+    /**
+     * Ticks a ready task waits before the priority policy raises its
+     * priority by one. Zero disables aging
+     */
+    unsigned int aging;
+    /**
+     * Number of levels of the multilevel feedback queue policy, between 1
+     * and MAX_LEVELS. The quantum doubles from one level to the next
+     */
+    unsigned int levels;
+    /**
+     * Ticks between two priority boosts of the multilevel feedback queue
+     * policy, which move every task back to the top level. Zero disables
+     * the boost
+     */
+    unsigned int boost;
+    /** Number of simulated CPUs, between 1 and MAX_CPUS */
+    unsigned int cpus;
+    Balancer_t balancer;
+    /**
+     * Number of partitions of the CPUs. The CPUs are split into sets of the
+     * same size and every task is pinned to one of them: task n runs on the
+     * CPUs of partition n % partitions. Tasks never leave their partition
+     */
+    unsigned int partitions;
+    /** Number of threads of the parallel engine */
+    unsigned int threads;
+
+} SimOptions_t;
+
+/**
+ * State of a simulated CPU.
+ */
+typedef struct {
+
+    /** Pointer to the task that is currently running on the CPU */
+    PCB_t * runningTask;
+
+    /** Tick in which the running task was dispatched */
+    unsigned int dispatchTime;
+
+    /** Ready queue of the CPU */
+    TaskQueue_t readyQueue;
+
+    /** Number of ticks in which the CPU has been busy */
+    unsigned long busyTicks;
+
+    /** PID of the running task in the last binary trace event */
+    unsigned int tracedPID;
+
+} Cpu_t;
+
+/**
+ * State of a simulation. Every simulation owns its clock, its queues and
+ * the tasks occupying the CPUs and the devices, so that several simulations
+ * can run concurrently on different threads.
+ */
+struct simulator {
+
+    SimOptions_t options;
+
+    /** Trace where the simulation is written */
+    Trace_t * trace;
+
+    /** Results of the finished tasks */
+    MetricsCollector_t metrics;
+
+    /**
+     * THE clock. Counts the number of ticks since the beginning of the
+     * execution
+     */
+    unsigned int clock;
+
+    /** Next PID to be assigned */
+    unsigned int nextPID;
+
+    /** Number of tasks currenty living on the system */
+    unsigned int livingTasks;
+
+    /** Where the tasks come from */
+    TaskSource_t * source;
+
+    /** Next task to arrive, already pulled from the source */
+    TaskDescriptor_t * nextArrival;
+
+    /** The CPUs, options.cpus of them */
+    Cpu_t * cpus;
+
+    /**
+     * The devices declared by the source, deviceCount of them. They are the
+     * devices of the simulator itself, unless it simulates a partition for
+     * the parallel engine, which shares the devices of the whole system
+     */
+    Device_t * devices;
+    unsigned int deviceCount;
+
+    /**
+     * Non-zero if the devices are the default ones of a workload that does
+     * not declare any, which are shown in their original order
+     */
+    int implicitDevices;
+
+    /** Storage of the devices of the simulator */
+    Device_t * ownDevices;
+
+    /**
+     * Non-zero once the simulation has run out of memory. The simulation
+     * then stops
+     */
+    int failed;
+
+};
+
+/**
+ * @brief Initializes a set of simulation options to their defaults.
+ *
+ * @param options Pointer to the options.
+ */
+void initSimOptions(SimOptions_t * options);
+
+/**
+ * @brief Initializes a simulator.
+ *
+ * @param sim Pointer to the simulator.
+ * @param options Knobs of the simulation.
+ * @param trace Trace where the simulation is written.
+ *
+ * @return 0 on success, -1 if there is not enough memory. The simulator can
+ * be released with freeSimulator() either way.
+ */
+int initSimulator(Simulator_t * sim, const SimOptions_t * options,
+                  Trace_t * trace);
+
+/**
+ * @brief Runs the simulation.
+ *
+ * This function runs the simulation of the given list of tasks until all of
+ * them have finished. The tick engine simulates every single clock tick,
+ * while the event engine jumps straight to the next tick in which a burst
+ * ends, a task arrives or the scheduler acts on a clock tick. Both engines
+ * produce exactly the same output.
+ *
+ * @param sim Pointer to the simulator.
+ * @param list Pointer to the list of task descriptors, sorted by start time.
+ *
+ * @return 0 on success, -1 if the simulation stopped because it ran out of
+ * memory or lost part of its trace.
+ */
+int runOS(Simulator_t * sim, TaskDescriptorList_t * list);
+
+/**
+ * @brief Runs the simulation of the tasks of a source.
+ *
+ * Same as runOS(), but the descriptors are pulled from the source right
+ * before they arrive and handed back as soon as they finish, so the
+ * simulator only holds the tasks that are living on the system.
+ *
+ * @param sim Pointer to the simulator.
+ * @param source Pointer to the source of the tasks.
+ *
+ * @return 0 on success, -1 if the simulation stopped because it ran out of
+ * memory or lost part of its trace.
+ */
+int runOSFromSource(Simulator_t * sim, TaskSource_t * source);
+
+/**
+ * @brief Resets a simulator to a clean system.
+ *
+ * The tasks are pulled from the given source and the results of the
+ * previous simulation are discarded. The devices of the simulator are
+ * rebuilt from the device table of the source.
+ *
+ * @param sim Pointer to the simulator.
+ * @param source Pointer to the source of the tasks.
+ *
+ * @return 0 on success, -1 if there is not enough memory for the devices.
+ */
+int resetSimulator(Simulator_t * sim, TaskSource_t * source);
+
+/**
+ * @brief Checks whether a simulation has failed.
+ *
+ * A simulation fails when it runs out of memory, or when its results or
+ * its trace are incomplete.
+ *
+ * @param sim Pointer to the simulator.
+ */
+int simulationFailed(Simulator_t * sim);
+
+/**
+ * @brief Starts the tasks that arrive at boot time.
+ *
+ * @param sim Pointer to the simulator.
+ */
+void startBootTasks(Simulator_t * sim);
+
+/**
+ * @brief Simulates the CPUs on the current tick.
+ *
+ * This function is the first step of a tick, after the clock has been
+ * advanced. It updates the bursts of the running tasks and launches the
+ * clock tick of every CPU.
+ *
+ * @param sim Pointer to the simulator.
+ */
+void simulateCpus(Simulator_t * sim);
+
+/**
+ * @brief Simulates the devices on the current tick.
+ *
+ * This function is the second step of a tick. It updates the bursts of the
+ * tasks that were using the channels of the devices when the tick began and
+ * launches the corresponding interrupts on the simulators the tasks belong
+ * to.
+ *
+ * @param sim Pointer to the simulator that owns the devices.
+ */
+void simulateDevices(Simulator_t * sim);
+
+/**
+ * @brief Hands a task to a device.
+ *
+ * The task is served by a free channel of the device from the next tick on.
+ * If every channel is busy, the task waits according to the queueing
+ * discipline of the device.
+ *
+ * @param sim Pointer to the simulator.
+ * @param device Index of the device.
+ * @param pcb Pointer to the PCB of the task.
+ */
+void requestDevice(Simulator_t * sim, unsigned int device, PCB_t * pcb);
+
+/**
+ * @brief Finishes the current tick.
+ *
+ * This function is the last step of a tick. It starts the tasks whose start
+ * time has been reached and balances the load of the CPUs.
+ *
+ * @param sim Pointer to the simulator.
+ */
+void finishTick(Simulator_t * sim);
+
+/**
+ * @brief Computes the number of ticks until the next event of the CPUs
+ *
+ * Same as the next event of the whole system, but the devices are left out.
+ *
+ * @param sim Pointer to the simulator.
+ *
+ * @return The number of ticks until the next event. It is always at least 1.
+ */
+unsigned int ticksToNextCpuEvent(Simulator_t * sim);
+
+/**
+ * @brief Skips a number of idle ticks of the CPUs
+ *
+ * @param sim Pointer to the simulator.
+ * @param ticks Number of idle ticks to skip.
+ */
+void skipCpuTicks(Simulator_t * sim, unsigned int ticks);
+
+/**
+ * @brief Computes the number of ticks until the next event of the devices
+ *
+ * @param sim Pointer to the simulator.
+ *
+ * @return The number of ticks until a channel finishes its burst. It is
+ * always at least 1.
+ */
+unsigned int ticksToNextDeviceEvent(Simulator_t * sim);
+
+/**
+ * @brief Skips a number of idle ticks of the devices
+ *
+ * @param sim Pointer to the simulator.
+ * @param ticks Number of idle ticks to skip.
+ */
+void skipDeviceTicks(Simulator_t * sim, unsigned int ticks);
+
+/**
+ * @brief Prints the summary of the last simulation.
+ *
+ * This function prints the number of ticks and tasks of the last simulation
+ * and the time the CPUs and the devices have been busy.
+ *
+ * @param sim Pointer to the simulator.
+ */
+void printSummary(Simulator_t * sim);
+
+/**
+ * @brief Releases the memory used by a simulator.
+ *
+ * @param sim Pointer to the simulator.
+ */
+void freeSimulator(Simulator_t * sim);
+
+#endif // __SIMULATOR_H__
@@ -0,0 +1,65 @@
+#ifndef __SOURCE_H__
+#define __SOURCE_H__
+
+#include <descriptors.h>
+
+/**
+ * Source of the tasks of a simulation. The simulator pulls the descriptors
+ * one by one, in start time order, right before they arrive, and hands
+ * them back once they have finished.
+ */
+typedef struct task_source {
+
+    /**
+     * @brief Next function
+     *
+     * This function must return the next task descriptor, reset to its
+     * pristine state. The start time of every descriptor must not be lower
+     * than the start time of the previous one.
+     *
+     * @param source Pointer to the source.
+     *
+     * @return Pointer to the descriptor or NULL if there are no more tasks.
+     *
+     */
+    TaskDescriptor_t * (* next)(struct task_source * source);
+
+    /**
+     * @brief Release function
+     *
+     * This function is called when the simulator does not need a descriptor
+     * any more, i.e. once the task has finished. The source may free it.
+     *
+     * @param source Pointer to the source.
+     * @param desc Pointer to the descriptor.
+     *
+     */
+    void (* release)(struct task_source * source, TaskDescriptor_t * desc);
+
+    /** Devices used by the tasks of the source */
+    const DeviceTable_t * devices;
+
+} TaskSource_t;
+
+/**
+ * Source that walks a list of descriptors that has been completely loaded
+ * in memory. The descriptors belong to the list, so they are never freed.
+ */
+typedef struct {
+
+    TaskSource_t source;
+
+    TaskDescriptor_t * cursor;
+
+} ListSource_t;
+
+/**
+ * @brief Opens a source over a list of descriptors
+ *
+ * @param listSource Pointer to the source.
+ * @param list Pointer to the list, sorted by start time.
+ *
+ */
+void openListSource(ListSource_t * listSource, TaskDescriptorList_t * list);
+
+#endif // __SOURCE_H__
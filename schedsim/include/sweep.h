@@ -0,0 +1,83 @@
+#ifndef __SWEEP_H__
+#define __SWEEP_H__
+
+#include <descriptors.h>
+#include <simulator.h>
+#include <trace.h>
+
+/**
+ * Simulation knob that can be swept.
+ */
+typedef struct {
+
+    /** Name of the knob, as given on the command line */
+    const char * name;
+
+    /** Range of valid values of the knob */
+    unsigned int min;
+    unsigned int max;
+
+    /**
+     * @brief Sets the value of the knob
+     *
+     * @param options Knobs of the simulation.
+     * @param value The new value of the knob.
+     */
+    void (* set)(SimOptions_t * options, unsigned int value);
+
+} SweepKnob_t;
+
+/**
+ * Range of values of a knob: from, from + step, ..., up to to.
+ */
+typedef struct {
+
+    const SweepKnob_t * knob;
+    unsigned int from;
+    unsigned int to;
+    unsigned int step;
+
+} SweepRange_t;
+
+/**
+ * @brief Parses a sweep specification
+ *
+ * The specification has the form knob=from:to[:step], e.g. quantum=1:100.
+ *
+ * @param range Pointer to the range that will store the specification.
+ * @param spec The specification.
+ *
+ * @return 0 on success, -1 if the specification is not valid.
+ */
+int parseSweepRange(SweepRange_t * range, const char * spec);
+
+/**
+ * @brief Returns the knobs that can be swept
+ *
+ * @return NULL-terminated array of knobs.
+ */
+const SweepKnob_t * const * getSweepKnobs();
+
+/**
+ * @brief Runs a parameter sweep
+ *
+ * This function simulates the workload under every given policy and every
+ * value of the range, on a pool of threads. Every thread simulates its own
+ * copy of the workload. The results are printed as CSV, one row per
+ * simulation, in policy and value order.
+ *
+ * @param list Pointer to the list of descriptors, sorted by start time.
+ * @param base Knobs shared by all the simulations.
+ * @param policies NULL-terminated array of the policies to simulate.
+ * @param range Range of values of the swept knob.
+ * @param threads Number of threads of the pool.
+ * @param output Trace where the CSV is written.
+ * @return 0 on success, -1 if the sweep has too many simulations or any of
+ * them fails. Nothing is printed then.
+ */
+int runSweep(const TaskDescriptorList_t * list, const SimOptions_t * base,
+             const SchedPolicy_t * const * policies,
+             const SweepRange_t * range, unsigned int threads,
+             Trace_t * output);
+
+#endif // __SWEEP_H__
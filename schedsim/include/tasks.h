@@ -20,20 +20,67 @@ typedef struct pcb {
 
     unsigned int priority;
     unsigned int timeslice;
+
+    /** CPU the task last ran on, or was placed on when it arrived */
+    unsigned int cpu;
+
+    /**
+     * Key of the task in the queues ordered by key, e.g. its virtual
+     * runtime. Lower keys go first
+     */
+    unsigned long long key;
     
     struct pcb * next;
     struct pcb * prev;
 
+    /** Links of the red-black tree that indexes a queue ordered by key */
+    struct pcb * parent;
+    struct pcb * left;
+    struct pcb * right;
+    int red;
+
 } PCB_t;
 
+/**
+ * Number of priority buckets of a queue. Priorities greater than or equal
+ * to QUEUE_BUCKETS - 1 share the last bucket.
+ */
+#define QUEUE_BUCKETS 256
+
+#ifdef BUCKET_QUEUES
+
+/** Number of words of the bitmap of non-empty buckets */
+#define QUEUE_BITMAP_WORDS (QUEUE_BUCKETS / (8 * sizeof(unsigned long)))
+
+#endif
+
 typedef struct {
 
     unsigned int size;
     PCB_t * first;
     PCB_t * last;
 
+    /**
+     * Root of the red-black tree that indexes the queue if it is ordered by
+     * key, NULL otherwise
+     */
+    PCB_t * root;
+
+#ifdef BUCKET_QUEUES
+    /** Bitmap of the priority buckets that contain at least one PCB */
+    unsigned long bitmap[QUEUE_BITMAP_WORDS];
+    /** Last PCB of every priority bucket, in queue order */
+    PCB_t * bucketLast[QUEUE_BUCKETS];
+#endif
+
 } TaskQueue_t;
 
+/**
+ * Function called on every state transition of a task.
+ */
+typedef void (* StateListener_t)(PCB_t * pcb, ProcessState_t previous,
+                                 ProcessState_t state);
+
 /**
  * @brief Initializes a PCB structure.
  *
@@ -78,12 +125,22 @@ ProcessState_t getState(PCB_t * pcb);
 /**
  * @brief Sets the state of a task.
  *
+ * If a state listener is registered, it is notified of the transition.
+ *
  * @param pcb Pointer to the PCB of the task.
  * @param priority The new state of the task.
  *
  */
 void setState(PCB_t * pcb, ProcessState_t state);
 
+/**
+ * @brief Registers the function notified of every state transition.
+ *
+ * @param listener The listener or NULL to unregister it.
+ *
+ */
+void setStateListener(StateListener_t listener);
+
 
 /**
  * @brief Returns the value of the remaining timeslice of a task.
@@ -104,6 +161,27 @@ unsigned int getTimeslice(PCB_t * pcb);
  */
 void setTimeslice(PCB_t * pcb, unsigned int timeslice);
 
+/**
+ * @brief Returns the key of a task.
+ *
+ * @param pcb Pointer to the PCB of the task.
+ *
+ * @return The key of the task.
+ *
+ */
+unsigned long long getKey(PCB_t * pcb);
+
+/**
+ * @brief Sets the key of a task.
+ *
+ * The key must not be changed while the task is in a queue ordered by key.
+ *
+ * @param pcb Pointer to the PCB of the task.
+ * @param key The new key of the task.
+ *
+ */
+void setKey(PCB_t * pcb, unsigned long long key);
+
 /**
  * @brief Initializes a task queue.
  *
@@ -127,7 +205,9 @@ void appendPCB(TaskQueue_t * queue, PCB_t * pcb);
  * @brief Adds a PCB on a queue ordered by its priority.
  *
  * This function adds a given PCB at the location corresponding to its
- * priority.
+ * priority. PCBs with the same priority are kept in FIFO order. When built
+ * with BUCKET_QUEUES, the location is found in constant time using a
+ * bitmap of priority buckets instead of walking the queue.
  *
  * @param queue Pointer to the queue to which the PCB will be added.
  * @param pcb Pointer to the PCB to be added.
@@ -135,6 +215,36 @@ void appendPCB(TaskQueue_t * queue, PCB_t * pcb);
  */
 void addPCBByPriority(TaskQueue_t * queue, PCB_t * pcb);
 
+/**
+ * @brief Raises by one the priority of the PCBs of a queue below a ceiling.
+ *
+ * The queue must be ordered by priority. The raised PCBs are the last ones
+ * of the queue and keep their place, so no PCB is moved. PCBs raised to the
+ * ceiling go after the ones that already had it.
+ *
+ * @param queue Pointer to the queue.
+ * @param ceiling Priority up to which the PCBs are raised. It must be
+ * greater than 0 and lower than QUEUE_BUCKETS - 1.
+ *
+ */
+void raisePriorities(TaskQueue_t * queue, unsigned int ceiling);
+
+/**
+ * @brief Adds a PCB on a queue ordered by its key.
+ *
+ * This function adds a given PCB at the location corresponding to its key,
+ * lower keys first. PCBs with the same key are kept in FIFO order. The
+ * queue is indexed by a red-black tree, so the location is found in
+ * logarithmic time, and extracting or removing a PCB also takes
+ * logarithmic time. A queue ordered by key must not be given PCBs with any
+ * other function.
+ *
+ * @param queue Pointer to the queue to which the PCB will be added.
+ * @param pcb Pointer to the PCB to be added.
+ *
+ */
+void addPCBByKey(TaskQueue_t * queue, PCB_t * pcb);
+
 /**
  * @brief Extracts the first PCB of a queue.
  *
@@ -161,6 +271,18 @@ PCB_t * extractFirst(TaskQueue_t * queue);
  */
 PCB_t * extractLast(TaskQueue_t * queue);
 
+/**
+ * @brief Removes a PCB from a queue.
+ *
+ * This function unlinks a given PCB from any position of the queue it
+ * belongs to.
+ *
+ * @param queue Pointer to the queue.
+ * @param pcb Pointer to the PCB, which must be in the queue.
+ *
+ */
+void removePCB(TaskQueue_t * queue, PCB_t * pcb);
+
 /**
  * @brief Returns the current size of the queue
  *
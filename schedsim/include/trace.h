@@ -0,0 +1,215 @@
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef enum {
+
+    TRACE_FULL = 0,
+    TRACE_OFF = 1,
+    TRACE_SAMPLED = 2,
+    TRACE_CHANGES = 3,
+    TRACE_BINARY = 4
+
+} TraceMode_t;
+
+typedef enum {
+
+    TRACE_EVENT_ARRIVAL = 0,
+    TRACE_EVENT_EXIT = 1,
+    TRACE_EVENT_SLOT = 2,
+    /** Declaration of a device, before any other event */
+    TRACE_EVENT_DEVICE = 3,
+    /** Change of the task served by a channel of a device */
+    TRACE_EVENT_CHANNEL = 4
+
+} TraceEventType_t;
+
+typedef enum {
+
+    /** Slot of the first CPU */
+    TRACE_SLOT_CPU = 0,
+    /** Slots of the devices of version 1 traces */
+    TRACE_SLOT_HARD_DISK = 1,
+    TRACE_SLOT_KEYBOARD = 2,
+    /** Slot of the second CPU. CPU n > 0 uses slot TRACE_SLOT_CPUS + n - 1 */
+    TRACE_SLOT_CPUS = 3
+
+} TraceSlot_t;
+
+/** Magic number at the beginning of a binary trace: "SSTR" */
+#define TRACE_MAGIC 0x52545353
+
+/** Version of the binary trace format */
+#define TRACE_VERSION 2
+
+/** PID stored in a slot event when the slot becomes empty */
+#define TRACE_NO_PID 0xffffffff
+
+/**
+ * Header of a binary trace file. It is followed by a sequence of records.
+ */
+typedef struct {
+
+    uint32_t magic;
+    uint32_t version;
+
+} TraceHeader_t;
+
+/**
+ * Record of a binary trace. Arrival records are followed by the command of
+ * the task, length bytes without the trailing '\0'. Slot records store the
+ * slot in the slot field and the PID of the task that occupies it after the
+ * tick, or TRACE_NO_PID if the slot became empty.
+ *
+ * Device records store the index of the device in the slot field and its
+ * number of channels in the pid field, and they are followed by the name of
+ * the device like arrival records. Channel records are slot records of a
+ * device channel: the device goes in the slot field and the channel in the
+ * length field.
+ */
+typedef struct {
+
+    uint32_t clock;
+    uint32_t pid;
+    uint8_t type;
+    uint8_t slot;
+    uint16_t length;
+
+} TraceRecord_t;
+
+/**
+ * State of a trace. Every simulation writes to its own trace, so that
+ * several simulations can run concurrently.
+ */
+typedef struct {
+
+    TraceMode_t mode;
+    unsigned int interval;
+    int fd;
+
+    /** THE output buffer, allocated on the first write */
+    char * buffer;
+    size_t bufferLength;
+
+    /** Status row being formatted */
+    char * row;
+    size_t rowLength;
+    size_t rowCapacity;
+
+    /** Last status row emitted, used by the state-change-only mode */
+    char * lastRow;
+    size_t lastRowLength;
+    size_t lastRowCapacity;
+    int lastRowValid;
+
+    /**
+     * Non-zero once a write or an allocation of the trace has failed. The
+     * rest of the output is then dropped
+     */
+    int failed;
+
+} Trace_t;
+
+/**
+ * @brief Opens the trace.
+ *
+ * All the output of the simulator goes through a large user-space buffer
+ * that is written to the given file descriptor when it fills up or when the
+ * trace is closed.
+ *
+ * @param trace Pointer to the trace.
+ * @param mode The trace mode.
+ * @param interval Number of ticks between rows in sampled mode.
+ * @param fd File descriptor where the trace is written.
+ */
+void openTrace(Trace_t * trace, TraceMode_t mode, unsigned int interval, int fd);
+
+/**
+ * @brief Flushes the trace buffer and closes the trace.
+ *
+ * @return 0 on success, -1 if any output of the trace has been lost.
+ */
+int closeTrace(Trace_t * trace);
+
+/**
+ * @brief Returns the current trace mode.
+ */
+TraceMode_t getTraceMode(Trace_t * trace);
+
+/**
+ * @brief Checks whether a write or an allocation of the trace has failed.
+ */
+int hasTraceFailed(Trace_t * trace);
+
+/**
+ * @brief Appends a formatted string to the trace buffer.
+ *
+ * The string is written regardless of the trace mode, so it is meant for
+ * headers and summaries only. In binary mode it goes to the standard error
+ * so that the binary log is not corrupted.
+ */
+void tracePrintf(Trace_t * trace, const char * format, ...);
+
+/**
+ * @brief Checks whether any status row of a range of ticks must be emitted.
+ *
+ * @param trace Pointer to the trace.
+ * @param first First tick of the range.
+ * @param count Number of ticks of the range.
+ * @param idle Non-zero if the state of the system is known to be the same
+ * as in the previous tick.
+ *
+ * @return Non-zero if the row must be formatted.
+ */
+int traceRowsWanted(Trace_t * trace, unsigned int first, unsigned int count,
+                    int idle);
+
+/**
+ * @brief Starts formatting a status row.
+ */
+void traceBeginRow(Trace_t * trace);
+
+/**
+ * @brief Appends a string to the status row being formatted.
+ */
+void traceRowString(Trace_t * trace, const char * string);
+
+/**
+ * @brief Emits the status row for a range of ticks.
+ *
+ * Depending on the trace mode, the row is written once per tick, once per
+ * sampled tick or only if it differs from the previous one.
+ *
+ * @param trace Pointer to the trace.
+ * @param first First tick of the range.
+ * @param count Number of ticks of the range.
+ */
+void traceEndRows(Trace_t * trace, unsigned int first, unsigned int count);
+
+/**
+ * @brief Logs the arrival of a task to the binary trace.
+ */
+void traceArrival(Trace_t * trace, unsigned int clock, unsigned int pid,
+                  const char * command);
+
+/**
+ * @brief Logs an event to the binary trace.
+ */
+void traceEvent(Trace_t * trace, unsigned int clock, TraceEventType_t type,
+                unsigned int pid, TraceSlot_t slot);
+
+/**
+ * @brief Logs the declaration of a device to the binary trace.
+ */
+void traceDevice(Trace_t * trace, unsigned int device, unsigned int channels,
+                 const char * name);
+
+/**
+ * @brief Logs the change of a device channel to the binary trace.
+ */
+void traceChannel(Trace_t * trace, unsigned int clock, unsigned int pid,
+                  unsigned int device, unsigned int channel);
+
+#endif // __TRACE_H__
@@ -0,0 +1,132 @@
+#ifndef __WORKLOAD_H__
+#define __WORKLOAD_H__
+
+#include <stdint.h>
+
+#include <descriptors.h>
+
+/** Magic number at the beginning of a binary workload: "SSWK" */
+#define WORKLOAD_MAGIC 0x4b575353
+
+/** Version of the binary workload format */
+#define WORKLOAD_VERSION 7
+
+/** Flag of a workload that does not declare its devices */
+#define WORKLOAD_IMPLICIT_DEVICES 0x1
+
+/**
+ * Header of a binary workload file. It is followed by:
+ *
+ * - devices device records, in declaration order.
+ * - tasks task records, sorted by start time.
+ * - The durations of all the bursts, bursts 32-bit words.
+ * - The sectors of all the bursts, sectors 32-bit words. There are either
+ *   none or one per burst.
+ * - The types of all the bursts, bursts bytes.
+ * - The string table, stringsSize bytes of '\0' terminated commands.
+ *
+ * The bursts of a task are contiguous, so a task only stores the index of
+ * its first burst and the number of bursts. All the fields are stored in
+ * the byte order of the machine that wrote the file.
+ */
+typedef struct {
+
+    uint32_t magic;
+    uint32_t version;
+    uint32_t tasks;
+    uint32_t devices;
+    uint64_t bursts;
+    uint64_t sectors;
+    uint64_t stringsSize;
+    /** WORKLOAD_* flags */
+    uint32_t flags;
+    /** Keeps the header 8-byte aligned, always 0 */
+    uint32_t reserved;
+
+} WorkloadHeader_t;
+
+typedef struct {
+
+    /** '\0' terminated names of the device and of its discipline */
+    char name[DEVICE_NAME_SIZE];
+    char discipline[DEVICE_NAME_SIZE];
+    uint32_t channels;
+    uint32_t deadline;
+    /** Ticks per sector of head travel */
+    uint32_t seek;
+    /** Keeps the records 8-byte aligned, always 0 */
+    uint32_t reserved;
+
+} WorkloadDevice_t;
+
+typedef struct {
+
+    uint32_t startTime;
+    uint32_t priority;
+    uint64_t firstBurst;
+    uint32_t bursts;
+    /** Offset of the command in the string table */
+    uint32_t command;
+    /** Quantum of the task, 0 to use the quantum of the simulation */
+    uint32_t quantum;
+    /** Partition the task is pinned to, UINT32_MAX if it is not pinned */
+    uint32_t partition;
+
+} WorkloadTask_t;
+
+/**
+ * @brief Checks whether a file is a binary workload
+ *
+ * @param fd File descriptor of the opened file.
+ *
+ * @return Non-zero if the file starts with the magic number.
+ *
+ */
+int isWorkloadFile(int fd);
+
+/**
+ * @brief Loads a binary workload
+ *
+ * This function maps the file and builds the descriptors with a single
+ * allocation. The bursts and the commands are not copied: they point into
+ * the mapping, which belongs to the list until freeDescriptors() is called.
+ * A malformed workload is rejected with a message on stderr.
+ *
+ * @param list Pointer to an empty list of descriptors.
+ * @param fd File descriptor of the opened workload file.
+ *
+ * @return 0 on success, -1 on error. On error, the list may hold some of
+ * the descriptors and must still be released with freeDescriptors().
+ *
+ */
+int loadWorkload(TaskDescriptorList_t * list, int fd);
+
+/**
+ * @brief Writes a list of descriptors as a binary workload
+ *
+ * @param list Pointer to the list, sorted by start time.
+ * @param fd File descriptor where the workload is written.
+ *
+ * @return 0 on success, -1 if the workload cannot be written.
+ *
+ */
+int writeWorkload(TaskDescriptorList_t * list, int fd);
+
+/**
+ * @brief Loads the descriptors of a workload file in any supported format
+ *
+ * Binary workloads are mapped with loadWorkload() and JSON files are parsed
+ * with parseDescriptorsParallel(). Either way, the list ends up sorted by
+ * start time.
+ *
+ * @param list Pointer to an empty list of descriptors.
+ * @param fd File descriptor of the opened workload file.
+ * @param threads Maximum number of threads used to parse a JSON file.
+ *
+ * @return 0 on success, -1 on error. On error, the list may hold some of
+ * the descriptors and must still be released with freeDescriptors().
+ *
+ */
+int readDescriptors(TaskDescriptorList_t * list, int fd, unsigned int threads);
+
+#endif // __WORKLOAD_H__
@@ -0,0 +1,165 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <arena.h>
+
+/** Size of the first block of an arena */
+#define ARENA_FIRST_BLOCK (64 * 1024)
+
+/** Blocks grow geometrically up to this size */
+#define ARENA_MAX_BLOCK (16 * 1024 * 1024)
+
+/** Alignment of every allocation */
+#define ARENA_ALIGN (sizeof(((ArenaBlock_t *)NULL)->data[0]))
+
+void initArena(Arena_t * arena) {
+
+    initArenaWithBlockSize(arena, ARENA_FIRST_BLOCK);
+
+}
+
+void initArenaWithBlockSize(Arena_t * arena, size_t blockSize) {
+
+    arena->blocks = NULL;
+    arena->blockSize = blockSize;
+
+}
+
+/**
+ * @brief Adds a new block to an arena.
+ *
+ * @param arena Pointer to the arena.
+ * @param size Minimum size of the data area of the block.
+ *
+ * @return 0 on success, -1 if there is not enough memory.
+ */
+static int growArena(Arena_t * arena, size_t size) {
+
+    ArenaBlock_t * block = NULL;
+    size_t blockSize = arena->blockSize;
+
+    if (blockSize < size) {
+
+        blockSize = size;
+
+    }
+
+    block = (ArenaBlock_t *)malloc(sizeof(ArenaBlock_t) + blockSize);
+
+    if (block == NULL) {
+
+        perror("Not enough memory for the arena");
+        return -1;
+
+    }
+
+    block->size = blockSize;
+    block->used = 0;
+    block->next = arena->blocks;
+
+    arena->blocks = block;
+
+    if (arena->blockSize < ARENA_MAX_BLOCK) {
+
+        arena->blockSize = arena->blockSize * 2;
+
+    }
+
+    return 0;
+
+}
+
+void * arenaAlloc(Arena_t * arena, size_t size) {
+
+    ArenaBlock_t * block = arena->blocks;
+    void * chunk = NULL;
+
+    // Round the size up so that the next chunk stays aligned
+    size = (size + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN;
+
+    if (block == NULL || block->size - block->used < size) {
+
+        if (growArena(arena, size) != 0) {
+
+            return NULL;
+
+        }
+
+        block = arena->blocks;
+
+    }
+
+    chunk = (char *)block->data + block->used;
+    block->used = block->used + size;
+
+    return chunk;
+
+}
+
+char * arenaStrndup(Arena_t * arena, const char * string, size_t length) {
+
+    char * copy = (char *)arenaAlloc(arena, length + 1);
+
+    if (copy == NULL) {
+
+        return NULL;
+
+    }
+
+    memcpy(copy, string, length);
+    copy[length] = '\0';
+
+    return copy;
+
+}
+
+void mergeArena(Arena_t * arena, Arena_t * other) {
+
+    ArenaBlock_t * last = other->blocks;
+
+    if (last == NULL) {
+
+        return;
+
+    }
+
+    if (arena->blocks == NULL) {
+
+        arena->blocks = other->blocks;
+
+    } else {
+
+        // Put the blocks of the other arena right after the current block,
+        // which stays the one used for the next allocations
+        while (last->next != NULL) {
+
+            last = last->next;
+
+        }
+
+        last->next = arena->blocks->next;
+        arena->blocks->next = other->blocks;
+
+    }
+
+    initArena(other);
+
+}
+
+void freeArena(Arena_t * arena) {
+
+    ArenaBlock_t * block = arena->blocks;
+    ArenaBlock_t * next = NULL;
+
+    while (block != NULL) {
+
+        next = block->next;
+        free(block);
+        block = next;
+
+    }
+
+    initArena(arena);
+
+}
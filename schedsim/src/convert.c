@@ -0,0 +1,75 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+#include <descriptors.h>
+#include <parser.h>
+#include <workload.h>
+
+int main(int argc, char * argv[]) {
+
+    TaskDescriptorList_t list;
+    int input = 0, output = 0;
+
+    if (argc != 3) {
+
+        fprintf(stderr, "Usage: schedsim_convert task_descriptors.json "
+                        "workload.bin\n");
+        exit(-1);
+
+    }
+
+    input = open(argv[1], O_RDONLY);
+
+    if (input < 0) {
+
+        perror("Error opening descriptors file:");
+        exit(-1);
+
+    }
+
+    output = open(argv[2], O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if (output < 0) {
+
+        perror("Error opening workload file:");
+        exit(-1);
+
+    }
+
+    initTaskDescriptorList(&list);
+
+    // The binary workload is stored sorted, so it can be loaded as is
+    if (parseDescriptorsParallel(&list, input,
+                                 sysconf(_SC_NPROCESSORS_ONLN)) != 0) {
+
+        exit(-1);
+
+    }
+
+    sortDescriptorsByStartTime(&list);
+
+    if (writeWorkload(&list, output) != 0) {
+
+        exit(-1);
+
+    }
+
+    freeDescriptors(&list);
+
+    close(input);
+
+    if (close(output) != 0) {
+
+        perror("Error writing the workload");
+        exit(-1);
+
+    }
+
+    return 0;
+
+}
@@ -1,40 +1,113 @@
 #include <stdio.h>
+#include <string.h>
 
 #include <descriptors.h>
 
 
-void initTaskBehaviour(TaskBehaviour_t * behaviour) {
+static void initTaskBursts(TaskBursts_t * bursts) {
 
-    behaviour->type = 0;
-    behaviour->remainingTime = 0;
+    bursts->size = 0;
 
-    behaviour->next = NULL;
-    behaviour->prev = NULL;
+    bursts->types = NULL;
+    bursts->durations = NULL;
+    bursts->sectors = NULL;
 
 }
 
-static void initTaskBehaviourList(TaskBehaviourList_t * list) {
+int allocTaskBursts(TaskBursts_t * bursts, Arena_t * arena, unsigned int size) {
 
-    list->size = 0;
+    // Durations first, so that they stay aligned
+    bursts->durations = (uint32_t *)arenaAlloc(arena, size * sizeof(uint32_t));
+    bursts->types = (uint8_t *)arenaAlloc(arena, size * sizeof(uint8_t));
 
-    list->first = NULL;
-    list->last = NULL;
+    bursts->size = size;
+    bursts->sectors = NULL;
+
+    return bursts->durations != NULL && bursts->types != NULL ? 0 : -1;
+
+}
+
+int allocTaskSectors(TaskBursts_t * bursts, Arena_t * arena) {
+
+    bursts->sectors = (uint32_t *)arenaAlloc(arena,
+                                             bursts->size * sizeof(uint32_t));
+
+    if (bursts->sectors == NULL) {
+
+        return -1;
+
+    }
+
+    memset(bursts->sectors, 0, bursts->size * sizeof(uint32_t));
+
+    return 0;
+
+}
+
+uint32_t getBurstSector(const TaskBursts_t * bursts, unsigned int index) {
+
+    return bursts->sectors != NULL ? bursts->sectors[index] : 0;
+
+}
+
+unsigned int getTaskPartition(const TaskDescriptor_t * desc, unsigned int pid,
+                              unsigned int partitions) {
+
+    if (desc->partition != ANY_PARTITION) {
+
+        return desc->partition % partitions;
+
+    }
+
+    return pid % partitions;
 
 }
 
 void initTaskDescriptor(TaskDescriptor_t * desc) {
 
     desc->startTime = 0;
+    desc->priority = 0;
+    desc->quantum = 0;
+    desc->partition = ANY_PARTITION;
     desc->items = 0;
-    desc->current = NULL;
+    desc->current = 0;
+    desc->remainingTime = 0;
+    desc->requestTime = 0;
+
+    initPCB(&(desc->pcb), 0, NULL, 0, 0);
 
-    initTaskBehaviourList(&(desc->behaviours));
+    desc->sim = NULL;
+
+    initTaskBursts(&(desc->bursts));
 
     desc->next = NULL;
     desc->prev = NULL;
 
 }
 
+void resetTaskDescriptor(TaskDescriptor_t * desc) {
+
+    initPCB(&(desc->pcb), 0, desc->pcb.command, desc->priority, 0);
+
+    desc->current = 0;
+    desc->remainingTime = desc->bursts.size != 0 ? desc->bursts.durations[0] : 0;
+
+    desc->sim = NULL;
+
+}
+
+void resetDescriptors(TaskDescriptorList_t * list) {
+
+    TaskDescriptor_t * desc = NULL;
+
+    for (desc = list->first; desc != NULL; desc = desc->next) {
+
+        resetTaskDescriptor(desc);
+
+    }
+
+}
+
 void initTaskDescriptorList(TaskDescriptorList_t * list) {
 
     list->size = 0;
@@ -42,6 +115,13 @@ void initTaskDescriptorList(TaskDescriptorList_t * list) {
     list->first = NULL;
     list->last = NULL; 
 
+    initArena(&(list->arena));
+
+    list->mapping = NULL;
+    list->mappingSize = 0;
+
+    initDeviceTable(&(list->devices));
+
 }
 
 void appendDescriptor(TaskDescriptorList_t * list, TaskDescriptor_t * desc) {
@@ -76,34 +156,200 @@ void appendDescriptor(TaskDescriptorList_t * list, TaskDescriptor_t * desc) {
 
 }
 
-void appendBehaviour(TaskBehaviourList_t * list, TaskBehaviour_t * behaviour) {
+void concatDescriptors(TaskDescriptorList_t * list,
+                       TaskDescriptorList_t * other) {
 
-    if (list->size == 0) {
+    if (other->size != 0) {
 
-        list->first = list->last = behaviour;
-        list->size = 1;
+        if (list->size == 0) {
 
-    } else {
+            list->first = other->first;
 
-        // Previous last element of the list
-        TaskBehaviour_t * prevLast = list->last;
+        } else {
 
-        // 1. Make the new behaviour point to NULL
-        behaviour->next = NULL;
+            list->last->next = other->first;
+            other->first->prev = list->last;
 
-        // 2. Make the previous last element point to the new element.
-        prevLast->next = behaviour;
+        }
 
-        // 3. Make the new behaviour point to the previous element, i.e.
-        // the previous last element.
-        behaviour->prev = prevLast;
+        list->last = other->last;
+        list->size = list->size + other->size;
 
-        // 4. Update the list's last element to the new element
-        list->last = behaviour;
+    }
 
-        // 5. Update the number of elements of the list
-        list->size = list->size + 1;
+    mergeArena(&(list->arena), &(other->arena));
+
+    other->size = 0;
+    other->first = NULL;
+    other->last = NULL;
+
+}
+
+/**
+ * @brief Merges two lists of descriptors sorted by start time.
+ *
+ * Only the next pointers are used. On equal start times, the descriptors of
+ * the first list go first.
+ *
+ * @param first First element of the first list.
+ * @param second First element of the second list.
+ *
+ * @return First element of the merged list.
+ *
+ */
+static TaskDescriptor_t * mergeByStartTime(TaskDescriptor_t * first,
+                                           TaskDescriptor_t * second) {
+
+    TaskDescriptor_t head;
+    TaskDescriptor_t * tail = &head;
+
+    while (first != NULL && second != NULL) {
+
+        if (first->startTime <= second->startTime) {
+
+            tail->next = first;
+            first = first->next;
+
+        } else {
+
+            tail->next = second;
+            second = second->next;
+
+        }
+
+        tail = tail->next;
+
+    }
+
+    tail->next = (first != NULL) ? first : second;
+
+    return head.next;
+
+}
+
+/**
+ * @brief Sorts a list of descriptors by start time.
+ *
+ * Only the next pointers are used and updated.
+ *
+ * @param first First element of the list.
+ *
+ * @return First element of the sorted list.
+ *
+ */
+static TaskDescriptor_t * mergeSortByStartTime(TaskDescriptor_t * first) {
+
+    TaskDescriptor_t * slow = first;
+    TaskDescriptor_t * fast = NULL;
+    TaskDescriptor_t * second = NULL;
+
+    if (first == NULL || first->next == NULL) {
+
+        return first;
+
+    }
+
+    // Split the list in two halves
+    fast = first->next;
+
+    while (fast != NULL && fast->next != NULL) {
+
+        slow = slow->next;
+        fast = fast->next->next;
+
+    }
+
+    second = slow->next;
+    slow->next = NULL;
+
+    return mergeByStartTime(mergeSortByStartTime(first),
+                            mergeSortByStartTime(second));
+
+}
+
+void sortDescriptorsByStartTime(TaskDescriptorList_t * list) {
+
+    TaskDescriptor_t * desc = NULL;
+    TaskDescriptor_t * prev = NULL;
+
+    list->first = mergeSortByStartTime(list->first);
+
+    // Restore the previous pointers and the last element of the list
+    for (desc = list->first; desc != NULL; desc = desc->next) {
+
+        desc->prev = prev;
+        prev = desc;
 
     }
 
+    list->last = prev;
+
+}
+
+int cloneDescriptors(TaskDescriptorList_t * copy,
+                      const TaskDescriptorList_t * list) {
+
+    TaskDescriptor_t * desc = NULL;
+    TaskDescriptor_t * descCopy = NULL;
+
+    initTaskDescriptorList(copy);
+
+    copy->devices = list->devices;
+
+    for (desc = list->first; desc != NULL; desc = desc->next) {
+
+        descCopy = (TaskDescriptor_t *)arenaAlloc(&(copy->arena),
+                                                  sizeof(TaskDescriptor_t));
+
+        if (descCopy == NULL) {
+
+            return -1;
+
+        }
+
+        initTaskDescriptor(descCopy);
+
+        descCopy->startTime = desc->startTime;
+        descCopy->priority = desc->priority;
+        descCopy->quantum = desc->quantum;
+        descCopy->partition = desc->partition;
+        descCopy->items = desc->items;
+
+        descCopy->pcb.command = arenaStrndup(&(copy->arena), desc->pcb.command,
+                                             strlen(desc->pcb.command));
+
+        if (descCopy->pcb.command == NULL ||
+            allocTaskBursts(&(descCopy->bursts), &(copy->arena),
+                            desc->bursts.size) != 0) {
+
+            return -1;
+
+        }
+
+        memcpy(descCopy->bursts.durations, desc->bursts.durations,
+               desc->bursts.size * sizeof(uint32_t));
+        memcpy(descCopy->bursts.types, desc->bursts.types,
+               desc->bursts.size * sizeof(uint8_t));
+
+        if (desc->bursts.sectors != NULL) {
+
+            if (allocTaskSectors(&(descCopy->bursts), &(copy->arena)) != 0) {
+
+                return -1;
+
+            }
+
+            memcpy(descCopy->bursts.sectors, desc->bursts.sectors,
+                   desc->bursts.size * sizeof(uint32_t));
+
+        }
+
+        resetTaskDescriptor(descCopy);
+
+        appendDescriptor(copy, descCopy);
+
+    }
+
+    return 0;
+
 }
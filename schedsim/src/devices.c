@@ -0,0 +1,504 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <descriptors.h>
+
+/**
+ * @brief Returns the sector accessed by the current burst of a task
+ */
+static uint32_t sectorOf(PCB_t * pcb) {
+
+    TaskDescriptor_t * desc = (TaskDescriptor_t *)pcb;
+
+    return getBurstSector(&(desc->bursts), desc->current);
+
+}
+
+/**
+ * @brief Returns the number of sectors the head moves to reach a sector
+ */
+static uint32_t seekDistance(uint32_t head, uint32_t sector) {
+
+    return sector > head ? sector - head : head - sector;
+
+}
+
+/**
+ * @brief Finds the request with the lowest sector at or above a given one
+ *
+ * @return The oldest of those requests or NULL if there is none.
+ */
+static PCB_t * findAbove(Device_t * device, uint32_t sector) {
+
+    PCB_t * pcb = NULL, * best = NULL;
+
+    for (pcb = device->waitingQueue.first; pcb != NULL; pcb = pcb->next) {
+
+        if (sectorOf(pcb) >= sector &&
+            (best == NULL || sectorOf(pcb) < sectorOf(best))) {
+
+            best = pcb;
+
+        }
+
+    }
+
+    return best;
+
+}
+
+/**
+ * @brief Finds the request with the highest sector at or below a given one
+ *
+ * @return The oldest of those requests or NULL if there is none.
+ */
+static PCB_t * findBelow(Device_t * device, uint32_t sector) {
+
+    PCB_t * pcb = NULL, * best = NULL;
+
+    for (pcb = device->waitingQueue.first; pcb != NULL; pcb = pcb->next) {
+
+        if (sectorOf(pcb) <= sector &&
+            (best == NULL || sectorOf(pcb) > sectorOf(best))) {
+
+            best = pcb;
+
+        }
+
+    }
+
+    return best;
+
+}
+
+/**
+ * @brief Removes a request from the waiting queue of a device
+ *
+ * @return The PCB of the request, which may be NULL.
+ */
+static PCB_t * takeRequest(Device_t * device, PCB_t * pcb) {
+
+    if (pcb != NULL) {
+
+        removePCB(&(device->waitingQueue), pcb);
+
+    }
+
+    return pcb;
+
+}
+
+static void enqueueFifo(Device_t * device, PCB_t * pcb) {
+
+    appendPCB(&(device->waitingQueue), pcb);
+
+}
+
+static PCB_t * dequeueFirst(Device_t * device, unsigned int clock) {
+
+    return extractFirst(&(device->waitingQueue));
+
+}
+
+static void enqueuePrio(Device_t * device, PCB_t * pcb) {
+
+    // Tasks with the same priority are served in arrival order
+    addPCBByPriority(&(device->waitingQueue), pcb);
+
+}
+
+static PCB_t * dequeueNearest(Device_t * device, unsigned int clock) {
+
+    PCB_t * pcb = NULL, * best = NULL;
+
+    // The queue is in arrival order, so the oldest request wins on a tie
+    for (pcb = device->waitingQueue.first; pcb != NULL; pcb = pcb->next) {
+
+        if (best == NULL || seekDistance(device->head, sectorOf(pcb)) <
+                            seekDistance(device->head, sectorOf(best))) {
+
+            best = pcb;
+
+        }
+
+    }
+
+    return takeRequest(device, best);
+
+}
+
+static PCB_t * dequeueElevator(Device_t * device, unsigned int clock) {
+
+    PCB_t * next = NULL;
+
+    // Keep sweeping in the same direction while there are requests ahead,
+    // and turn around otherwise
+    next = device->descending ? findBelow(device, device->head) :
+                                findAbove(device, device->head);
+
+    if (next == NULL) {
+
+        device->descending = !device->descending;
+
+        next = device->descending ? findBelow(device, device->head) :
+                                    findAbove(device, device->head);
+
+    }
+
+    return takeRequest(device, next);
+
+}
+
+static PCB_t * dequeueDeadline(Device_t * device, unsigned int clock) {
+
+    PCB_t * oldest = device->waitingQueue.first;
+    PCB_t * next = NULL;
+
+    if (oldest == NULL) {
+
+        return NULL;
+
+    }
+
+    // The queue is in arrival order, so only the first request may have
+    // expired before the others
+    if (clock - ((TaskDescriptor_t *)oldest)->requestTime >= device->deadline) {
+
+        return takeRequest(device, oldest);
+
+    }
+
+    next = findAbove(device, device->head);
+
+    if (next == NULL) {
+
+        next = findAbove(device, 0);
+
+    }
+
+    return takeRequest(device, next);
+
+}
+
+/**
+ * @brief Returns the home slot of a task in the service table of a device
+ */
+static unsigned int serviceSlot(const Device_t * device, const PCB_t * pcb) {
+
+    // The low bits of a PCB address are the same for every task
+    return (unsigned int)(((uintptr_t)pcb >> 4) * 2654435761u) &
+           (device->serviceCapacity - 1);
+
+}
+
+/**
+ * @brief Finds the account of a task on a device
+ *
+ * @return The slot of the task or the free slot where it would be stored.
+ */
+static DeviceService_t * findService(const Device_t * device,
+                                     const PCB_t * pcb) {
+
+    unsigned int slot = serviceSlot(device, pcb);
+
+    while (device->services[slot].pcb != NULL &&
+           device->services[slot].pcb != pcb) {
+
+        slot = (slot + 1) & (device->serviceCapacity - 1);
+
+    }
+
+    return &(device->services[slot]);
+
+}
+
+/**
+ * @brief Returns the service a task has received from a device
+ */
+static unsigned long getService(const Device_t * device, const PCB_t * pcb) {
+
+    const DeviceService_t * service = NULL;
+
+    if (device->serviceCount == 0) {
+
+        return 0;
+
+    }
+
+    // A free slot may keep the service of a task that has left
+    service = findService(device, pcb);
+
+    return service->pcb != NULL ? service->ticks : 0;
+
+}
+
+/**
+ * @brief Doubles the capacity of the service table of a device
+ *
+ * @return 0 on success, -1 if there is not enough memory.
+ */
+static int growServices(Device_t * device) {
+
+    DeviceService_t * old = device->services;
+    unsigned int capacity = device->serviceCapacity;
+    unsigned int i = 0;
+
+    device->services = (DeviceService_t *)calloc(capacity == 0 ? 64 :
+                                                 capacity * 2,
+                                                 sizeof(DeviceService_t));
+
+    if (device->services == NULL) {
+
+        perror("Not enough memory for the service of the tasks");
+        device->services = old;
+        return -1;
+
+    }
+
+    device->serviceCapacity = capacity == 0 ? 64 : capacity * 2;
+
+    for (i = 0; i < capacity; i++) {
+
+        if (old[i].pcb != NULL) {
+
+            *findService(device, old[i].pcb) = old[i];
+
+        }
+
+    }
+
+    free(old);
+
+    return 0;
+
+}
+
+int addDeviceService(Device_t * device, PCB_t * pcb, unsigned long ticks) {
+
+    DeviceService_t * service = NULL;
+
+    if (!device->discipline->tracksService) {
+
+        return 0;
+
+    }
+
+    // The table is kept at most half full
+    if ((device->serviceCount + 1) * 2 > device->serviceCapacity &&
+        growServices(device) != 0) {
+
+        return -1;
+
+    }
+
+    service = findService(device, pcb);
+
+    if (service->pcb == NULL) {
+
+        service->pcb = pcb;
+        service->ticks = 0;
+        device->serviceCount = device->serviceCount + 1;
+
+    }
+
+    service->ticks = service->ticks + ticks;
+
+    return 0;
+
+}
+
+void forgetDeviceService(Device_t * device, PCB_t * pcb) {
+
+    DeviceService_t * service = NULL;
+    unsigned int slot = 0, next = 0, home = 0;
+
+    if (device->serviceCount == 0) {
+
+        return;
+
+    }
+
+    service = findService(device, pcb);
+
+    if (service->pcb == NULL) {
+
+        return;
+
+    }
+
+    // Shift back the tasks that probed past the freed slot, so that no
+    // search stops at it too early
+    slot = service - device->services;
+    next = (slot + 1) & (device->serviceCapacity - 1);
+
+    while (device->services[next].pcb != NULL) {
+
+        home = serviceSlot(device, device->services[next].pcb);
+
+        if (((next - home) & (device->serviceCapacity - 1)) >=
+            ((next - slot) & (device->serviceCapacity - 1))) {
+
+            device->services[slot] = device->services[next];
+            slot = next;
+
+        }
+
+        next = (next + 1) & (device->serviceCapacity - 1);
+
+    }
+
+    device->services[slot].pcb = NULL;
+    device->serviceCount = device->serviceCount - 1;
+
+}
+
+/**
+ * @brief Checks whether a task is entitled to a device before another one
+ *
+ * Every task gets a share of the device proportional to its priority plus
+ * one, so the task with the lowest service from the device over its share
+ * goes first.
+ */
+static int lessServed(const Device_t * device, PCB_t * pcb, PCB_t * other) {
+
+    TaskDescriptor_t * desc = (TaskDescriptor_t *)pcb;
+    TaskDescriptor_t * otherDesc = (TaskDescriptor_t *)other;
+
+    return (unsigned long long)getService(device, pcb) *
+           (otherDesc->priority + 1ULL) <
+           (unsigned long long)getService(device, other) *
+           (desc->priority + 1ULL);
+
+}
+
+static PCB_t * dequeueFair(Device_t * device, unsigned int clock) {
+
+    PCB_t * pcb = NULL, * best = NULL;
+
+    for (pcb = device->waitingQueue.first; pcb != NULL; pcb = pcb->next) {
+
+        if (best == NULL || lessServed(device, pcb, best)) {
+
+            best = pcb;
+
+        }
+
+    }
+
+    return takeRequest(device, best);
+
+}
+
+const DeviceDiscipline_t fifoDiscipline = {
+
+    .name = "fifo",
+
+    .enqueue = enqueueFifo,
+    .dequeue = dequeueFirst
+
+};
+
+const DeviceDiscipline_t prioDiscipline = {
+
+    .name = "prio",
+
+    .enqueue = enqueuePrio,
+    .dequeue = dequeueFirst
+
+};
+
+const DeviceDiscipline_t sstfDiscipline = {
+
+    .name = "sstf",
+
+    .enqueue = enqueueFifo,
+    .dequeue = dequeueNearest
+
+};
+
+const DeviceDiscipline_t elevatorDiscipline = {
+
+    .name = "elevator",
+
+    .enqueue = enqueueFifo,
+    .dequeue = dequeueElevator
+
+};
+
+const DeviceDiscipline_t deadlineDiscipline = {
+
+    .name = "deadline",
+
+    .enqueue = enqueueFifo,
+    .dequeue = dequeueDeadline
+
+};
+
+const DeviceDiscipline_t bfqDiscipline = {
+
+    .name = "bfq",
+
+    .enqueue = enqueueFifo,
+    .dequeue = dequeueFair,
+
+    .tracksService = 1
+
+};
+
+/** Available queueing disciplines, the first one is the default */
+static const DeviceDiscipline_t * const disciplines[] = {
+    &fifoDiscipline,
+    &prioDiscipline,
+    &sstfDiscipline,
+    &elevatorDiscipline,
+    &deadlineDiscipline,
+    &bfqDiscipline,
+    NULL
+};
+
+const DeviceDiscipline_t * findDiscipline(const char * name) {
+
+    int i = 0;
+
+    for (i = 0; disciplines[i] != NULL; i++) {
+
+        if (strcmp(disciplines[i]->name, name) == 0) {
+
+            return disciplines[i];
+
+        }
+
+    }
+
+    return NULL;
+
+}
+
+/**
+ * @brief Appends a device to a table
+ */
+static void addDevice(DeviceTable_t * table, const char * name) {
+
+    DeviceConfig_t * config = &(table->devices[table->size]);
+
+    snprintf(config->name, DEVICE_NAME_SIZE, "%s", name);
+    config->channels = 1;
+    config->discipline = disciplines[0];
+    config->deadline = DEFAULT_DEADLINE;
+    config->seek = 0;
+
+    table->size = table->size + 1;
+
+}
+
+void initDeviceTable(DeviceTable_t * table) {
+
+    table->size = 0;
+    table->implicit = 1;
+
+    addDevice(table, "Hard Disk");
+    addDevice(table, "Keyboard");
+
+}
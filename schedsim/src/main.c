@@ -1,6 +1,8 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
+#include <getopt.h>
 
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -8,24 +10,293 @@
 
 #include <descriptors.h>
 #include <parser.h>
-#include <os.h>
+#include <simulator.h>
+#include <sched.h>
+#include <trace.h>
+#include <metrics.h>
+#include <sweep.h>
+#include <workload.h>
 
-void runOS(TaskDescriptorList_t * list);
+/** Maximum number of policies compared side by side */
+#define MAX_POLICIES 16
+
+/**
+ * @brief Simulates the same workload under every scheduling policy
+ *
+ * The descriptors are parsed only once. Before every run they are reset to
+ * their pristine state. Finally, the metrics of all the runs are printed
+ * side by side.
+ *
+ * @param list Pointer to the list of descriptors.
+ * @param base Knobs shared by all the runs.
+ * @param trace Trace where the comparison is printed.
+ *
+ */
+static void comparePolicies(TaskDescriptorList_t * list,
+                            const SimOptions_t * base, Trace_t * trace) {
+
+    const SchedPolicy_t * const * policies = getPolicies();
+    const char * names[MAX_POLICIES];
+    MetricsSummary_t summaries[MAX_POLICIES];
+    unsigned int ticks[MAX_POLICIES];
+    unsigned int count = 0;
+    SimOptions_t options = *base;
+    Simulator_t sim;
+
+    for (count = 0; policies[count] != NULL && count < MAX_POLICIES; count++) {
+
+        resetDescriptors(list);
+
+        options.policy = policies[count];
+
+        if (initSimulator(&sim, &options, trace) != 0 ||
+            runOS(&sim, list) != 0 ||
+            summarizeMetrics(&(sim.metrics), &summaries[count]) != 0) {
+
+            exit(-1);
+
+        }
+
+        names[count] = policies[count]->name;
+        ticks[count] = sim.clock;
+
+        freeSimulator(&sim);
+
+    }
+
+    printMetricsComparison(trace, names, summaries, ticks, count);
+
+}
+
+static void usage() {
+
+    const SchedPolicy_t * const * policies = getPolicies();
+    const SweepKnob_t * const * knobs = getSweepKnobs();
+    int i = 0;
+
+    fprintf(stderr, "Usage: schedsim [--policy=");
+
+    for (i = 0; policies[i] != NULL; i++) {
+
+        fprintf(stderr, "%s%s", i == 0 ? "" : "|", policies[i]->name);
+
+    }
+
+    fprintf(stderr, "] [--engine=tick|event|parallel] "
+                    "[--trace=full|off|sampled|changes|binary] "
+                    "[--trace-interval=ticks] [--trace-file=file] "
+                    "[--quantum=ticks] [--aging=ticks] [--levels=n] [--boost=ticks] "
+                    "[--cpus=n] [--balancer=none|push|steal] "
+                    "[--partitions=n] "
+                    "[--metrics] [--compare] [--stream] "
+                    "[--sweep=");
+
+    for (i = 0; knobs[i] != NULL; i++) {
+
+        fprintf(stderr, "%s%s", i == 0 ? "" : "|", knobs[i]->name);
+
+    }
+
+    fprintf(stderr, "=from:to[:step]] [--threads=n] "
+                    "task_descriptors|workload.bin\n");
+    exit(-1);
+
+}
 
 int main(int argc, char * argv[]) {
 
     int fd = 0;
+    int traceFd = STDOUT_FILENO;
+    int option = 0;
+    int metrics = 0;
+    int compare = 0;
+    int sweep = 0;
+    int stream = 0;
+    int result = 0;
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+
+    SimOptions_t simOptions;
+    Simulator_t sim;
+    StreamSource_t streamSource;
+    SweepRange_t range;
+    SimOptions_t sweptOptions;
+    unsigned long long value = 0;
+
+    TraceMode_t traceMode = TRACE_FULL;
+    unsigned int traceInterval = 1;
+    char * traceFile = NULL;
 
     TaskDescriptorList_t list;
+    Trace_t trace;
 
-    if (argc != 2) {
+    static struct option options[] = {
+        { "policy", required_argument, NULL, 'p' },
+        { "engine", required_argument, NULL, 'e' },
+        { "trace", required_argument, NULL, 't' },
+        { "trace-interval", required_argument, NULL, 'i' },
+        { "trace-file", required_argument, NULL, 'o' },
+        { "metrics", no_argument, NULL, 'm' },
+        { "compare", no_argument, NULL, 'c' },
+        { "quantum", required_argument, NULL, 'q' },
+        { "aging", required_argument, NULL, 'a' },
+        { "levels", required_argument, NULL, 'l' },
+        { "boost", required_argument, NULL, 'B' },
+        { "sweep", required_argument, NULL, 's' },
+        { "threads", required_argument, NULL, 'j' },
+        { "stream", no_argument, NULL, 'S' },
+        { "cpus", required_argument, NULL, 'n' },
+        { "balancer", required_argument, NULL, 'b' },
+        { "partitions", required_argument, NULL, 'P' },
+        { NULL, 0, NULL, 0 }
+    };
 
-        fprintf(stderr, "Usage: schedsim task_descriptors\n");
-        exit(-1);
+    initSimOptions(&simOptions);
+
+    while ((option = getopt_long(argc, argv, "p:e:t:i:o:mcq:a:l:B:s:j:Sn:b:P:", options, NULL)) != -1) {
+
+        switch (option) {
+        case 'p':
+            simOptions.policy = findPolicy(optarg);
+            if (simOptions.policy == NULL) {
+                usage();
+            }
+            break;
+        case 'e':
+            if (strcmp(optarg, "tick") == 0) {
+                simOptions.engine = TICK_ENGINE;
+            } else if (strcmp(optarg, "event") == 0) {
+                simOptions.engine = EVENT_ENGINE;
+            } else if (strcmp(optarg, "parallel") == 0) {
+                simOptions.engine = PARALLEL_ENGINE;
+            } else {
+                usage();
+            }
+            break;
+        case 't':
+            if (strcmp(optarg, "full") == 0) {
+                traceMode = TRACE_FULL;
+            } else if (strcmp(optarg, "off") == 0) {
+                traceMode = TRACE_OFF;
+            } else if (strcmp(optarg, "sampled") == 0) {
+                traceMode = TRACE_SAMPLED;
+            } else if (strcmp(optarg, "changes") == 0) {
+                traceMode = TRACE_CHANGES;
+            } else if (strcmp(optarg, "binary") == 0) {
+                traceMode = TRACE_BINARY;
+            } else {
+                usage();
+            }
+            break;
+        case 'i':
+            traceInterval = strtoul(optarg, NULL, 10);
+            if (traceInterval == 0) {
+                usage();
+            }
+            break;
+        case 'o':
+            traceFile = optarg;
+            break;
+        case 'm':
+            metrics = 1;
+            break;
+        case 'c':
+            compare = 1;
+            break;
+        case 'q':
+            simOptions.quantum = strtoul(optarg, NULL, 10);
+            if (simOptions.quantum == 0) {
+                usage();
+            }
+            break;
+        case 'a':
+            // Zero disables aging
+            simOptions.aging = strtoul(optarg, NULL, 10);
+            break;
+        case 'l':
+            simOptions.levels = strtoul(optarg, NULL, 10);
+            if (simOptions.levels == 0 || simOptions.levels > MAX_LEVELS) {
+                usage();
+            }
+            break;
+        case 'B':
+            // Zero disables the boost
+            simOptions.boost = strtoul(optarg, NULL, 10);
+            break;
+        case 's':
+            if (parseSweepRange(&range, optarg) != 0) {
+                usage();
+            }
+            sweep = 1;
+            break;
+        case 'j':
+            threads = strtol(optarg, NULL, 10);
+            if (threads <= 0) {
+                usage();
+            }
+            break;
+        case 'S':
+            stream = 1;
+            break;
+        case 'n':
+            simOptions.cpus = strtoul(optarg, NULL, 10);
+            if (simOptions.cpus == 0 || simOptions.cpus > MAX_CPUS) {
+                usage();
+            }
+            break;
+        case 'b':
+            if (strcmp(optarg, "none") == 0) {
+                simOptions.balancer = BALANCE_NONE;
+            } else if (strcmp(optarg, "push") == 0) {
+                simOptions.balancer = BALANCE_PUSH;
+            } else if (strcmp(optarg, "steal") == 0) {
+                simOptions.balancer = BALANCE_STEAL;
+            } else {
+                usage();
+            }
+            break;
+        case 'P':
+            simOptions.partitions = strtoul(optarg, NULL, 10);
+            if (simOptions.partitions == 0) {
+                usage();
+            }
+            break;
+        default:
+            usage();
+        }
 
     }
 
-    fd = open(argv[1], O_RDONLY);
+    // A streamed workload can only be simulated once, and every partition
+    // must have the same number of CPUs
+    if (argc - optind != 1 || (stream && (compare || sweep)) ||
+        (!sweep && simOptions.cpus % simOptions.partitions != 0)) {
+
+        usage();
+
+    }
+
+    // Every simulation of a sweep must be able to split its CPUs. The value
+    // is 64 bits wide so that stepping past a range ending at UINT_MAX ends
+    if (sweep) {
+
+        for (value = range.from; value <= range.to; value += range.step) {
+
+            sweptOptions = simOptions;
+            range.knob->set(&sweptOptions, (unsigned int)value);
+
+            if (sweptOptions.cpus % sweptOptions.partitions != 0) {
+
+                usage();
+
+            }
+
+        }
+
+    }
+
+    simOptions.threads = threads;
+
+    fd = open(argv[optind], O_RDONLY);
     
     if (fd < 0) {
 
@@ -34,14 +305,150 @@ int main(int argc, char * argv[]) {
 
     }
 
+    if (traceFile != NULL) {
+
+        traceFd = open(traceFile, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+        if (traceFd < 0) {
+
+            perror("Error opening trace file:");
+            exit(-1);
+
+        }
+
+    }
+
+    // Binary workloads are mapped without parsing, so there is nothing to
+    // gain from streaming them
+    if (stream && isWorkloadFile(fd)) {
+
+        stream = 0;
+
+    }
+
     initTaskDescriptorList(&list);
 
-    parseDescriptors(&list, fd);
+    // The parser reports why the file is malformed
+    if (!stream && readDescriptors(&list, fd, threads > 0 ? threads : 1) != 0) {
+
+        exit(-1);
+
+    }
+
+    if (sweep) {
+
+        // Only the CSV is printed. With --compare every policy is swept
+        openTrace(&trace, TRACE_OFF, traceInterval, traceFd);
+
+        if (compare) {
+
+            if (runSweep(&list, &simOptions, getPolicies(), &range,
+                         threads > 0 ? threads : 1, &trace) != 0) {
+
+                exit(-1);
+
+            }
+
+        } else {
+
+            const SchedPolicy_t * policies[] = { simOptions.policy, NULL };
+
+            if (runSweep(&list, &simOptions, policies, &range,
+                         threads > 0 ? threads : 1, &trace) != 0) {
+
+                exit(-1);
+
+            }
+
+        }
+
+    } else if (compare) {
+
+        // Only the comparison table is printed
+        openTrace(&trace, TRACE_OFF, traceInterval, traceFd);
+
+        comparePolicies(&list, &simOptions, &trace);
+
+    } else {
+
+        openTrace(&trace, traceMode, traceInterval, traceFd);
+
+        if (initSimulator(&sim, &simOptions, &trace) != 0) {
+
+            exit(-1);
+
+        }
+
+        if (stream) {
+
+            // The tasks are parsed as they arrive and freed as they finish
+            if (openStreamSource(&streamSource, fd) != 0) {
+
+                exit(-1);
+
+            }
+
+            result = runOSFromSource(&sim, &(streamSource.source));
 
-    runOS(&list);
+            closeStreamSource(&streamSource);
+
+            // A malformed task ends the stream early, so the results are
+            // meaningless
+            if (streamSource.failed) {
+
+                exit(-1);
+
+            }
+
+        } else {
+
+            result = runOS(&sim, &list);
+
+        }
+
+        if (result != 0) {
+
+            exit(-1);
+
+        }
+
+        if (traceMode == TRACE_OFF) {
+
+            printSummary(&sim);
+
+        }
+
+        if (metrics || traceMode == TRACE_OFF) {
+
+            if (printMetrics(&(sim.metrics), &trace) != 0 ||
+                printLatencies(&(sim.metrics), sim.devices, sim.deviceCount,
+                               &trace) != 0 ||
+                printLevels(&(sim.metrics), sim.clock, &trace) != 0) {
+
+                exit(-1);
+
+            }
+
+        }
+
+        freeSimulator(&sim);
+
+    }
+
+    if (closeTrace(&trace) != 0) {
+
+        exit(-1);
+
+    }
 
     freeDescriptors(&list);
 
     close(fd);
 
+    if (traceFd != STDOUT_FILENO) {
+
+        close(traceFd);
+
+    }
+
 }
@@ -0,0 +1,670 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <metrics.h>
+#include <descriptors.h>
+#include <simulator.h>
+#include <trace.h>
+
+/** The state listener is registered only once for all the simulations */
+static pthread_once_t listenerOnce = PTHREAD_ONCE_INIT;
+
+static const char * metricNames[METRICS] = {
+    "Turnaround", "Response", "Ready wait", "I/O wait", "Switches",
+    "Preemptions"
+};
+
+static const char * metricKeys[METRICS] = {
+    "turnaround", "response", "ready_wait", "io_wait", "switches",
+    "preemptions"
+};
+
+/**
+ * @brief Doubles the capacity of a collector.
+ *
+ * If there is not enough memory, the collector keeps its capacity and is
+ * marked as failed.
+ *
+ * @param collector Pointer to the collector.
+ * @return 0 on success, -1 if there is not enough memory.
+ */
+static int growResults(MetricsCollector_t * collector) {
+
+    unsigned int capacity = collector->capacity == 0 ? 1024 :
+                            collector->capacity * 2;
+    unsigned int * results = NULL;
+    int i = 0;
+
+    for (i = 0; i < METRICS; i++) {
+
+        results = (unsigned int *)realloc(collector->results[i],
+                                          capacity * sizeof(unsigned int));
+
+        if (results == NULL) {
+
+            perror("Not enough memory for the metrics");
+            collector->failed = 1;
+            return -1;
+
+        }
+
+        collector->results[i] = results;
+
+    }
+
+    collector->capacity = capacity;
+
+    return 0;
+
+}
+
+/**
+ * @brief Makes room for one more latency sample.
+ *
+ * @return 0 on success, -1 if there is not enough memory.
+ */
+static int growLatencies(LatencySamples_t * samples) {
+
+    unsigned int capacity = samples->capacity == 0 ? 1024 :
+                            samples->capacity * 2;
+    unsigned int * latencies = NULL;
+
+    latencies = (unsigned int *)realloc(samples->latencies,
+                                        capacity * sizeof(unsigned int));
+
+    if (latencies == NULL) {
+
+        perror("Not enough memory for the metrics");
+        return -1;
+
+    }
+
+    samples->latencies = latencies;
+    samples->capacity = capacity;
+
+    return 0;
+
+}
+
+/**
+ * @brief Stores the results of a finished task.
+ *
+ * @param collector Pointer to the collector.
+ * @param metrics Pointer to the metrics of the task.
+ */
+static void recordTask(MetricsCollector_t * collector, TaskMetrics_t * metrics) {
+
+    unsigned int ** results = collector->results;
+    unsigned int count = collector->count;
+
+    if (count == collector->capacity && growResults(collector) != 0) {
+
+        return;
+
+    }
+
+    results[METRIC_TURNAROUND][count] = metrics->completion - metrics->arrival;
+    results[METRIC_RESPONSE][count] = metrics->firstDispatch - metrics->arrival;
+    results[METRIC_READY_WAIT][count] = metrics->readyWait;
+    results[METRIC_IO_WAIT][count] = metrics->ioWait;
+    results[METRIC_SWITCHES][count] = metrics->contextSwitches;
+    results[METRIC_PREEMPTIONS][count] = metrics->preemptions;
+
+    collector->count = count + 1;
+
+}
+
+/**
+ * @brief Updates the metrics of a task on a state transition.
+ *
+ * The time elapsed since the previous transition is accounted to the state
+ * the task is leaving. Tasks that do not belong to a simulator are not
+ * accounted.
+ */
+static void updateMetrics(PCB_t * pcb, ProcessState_t previous,
+                          ProcessState_t state) {
+
+    TaskDescriptor_t * desc = (TaskDescriptor_t *)pcb;
+    TaskMetrics_t * metrics = &(desc->metrics);
+    unsigned int now = 0;
+    unsigned int elapsed = 0;
+
+    if (desc->sim == NULL) {
+
+        return;
+
+    }
+
+    now = desc->sim->clock;
+
+    if (previous == INIT) {
+
+        // The task has just arrived to the system
+        memset(metrics, 0, sizeof(TaskMetrics_t));
+        metrics->arrival = now;
+
+    } else {
+
+        elapsed = now - metrics->lastTransition;
+
+        if (previous == READY) {
+
+            metrics->readyWait = metrics->readyWait + elapsed;
+
+        } else if (previous == WAITING) {
+
+            metrics->ioWait = metrics->ioWait + elapsed;
+
+        } else if (previous == RUNNING && state == READY) {
+
+            metrics->preemptions = metrics->preemptions + 1;
+
+        }
+
+    }
+
+    metrics->lastTransition = now;
+
+    if (state == RUNNING && previous != RUNNING) {
+
+        metrics->contextSwitches = metrics->contextSwitches + 1;
+
+        if (!metrics->dispatched) {
+
+            metrics->dispatched = 1;
+            metrics->firstDispatch = now;
+
+        }
+
+    } else if (state == FINISHED && previous != FINISHED) {
+
+        metrics->completion = now;
+
+        // A task that never got the CPU responds when it finishes
+        if (!metrics->dispatched) {
+
+            metrics->firstDispatch = now;
+
+        }
+
+        recordTask(&(desc->sim->metrics), metrics);
+
+    }
+
+}
+
+/**
+ * @brief Appends a sample to a set of latencies.
+ *
+ * @return 0 on success, -1 if there is not enough memory.
+ */
+static int addSample(LatencySamples_t * samples, unsigned int latency) {
+
+    if (samples->count == samples->capacity && growLatencies(samples) != 0) {
+
+        return -1;
+
+    }
+
+    samples->latencies[samples->count] = latency;
+    samples->count = samples->count + 1;
+
+    return 0;
+
+}
+
+void recordLatency(MetricsCollector_t * metrics, unsigned int device,
+                   unsigned int latency) {
+
+    if (addSample(&(metrics->devices[device]), latency) != 0) {
+
+        metrics->failed = 1;
+
+    }
+
+}
+
+void recordLevelWait(MetricsCollector_t * metrics, unsigned int level,
+                     unsigned int wait) {
+
+    if (addSample(&(metrics->levels[level]), wait) != 0) {
+
+        metrics->failed = 1;
+
+    }
+
+}
+
+static int compareUnsigned(const void * a, const void * b) {
+
+    unsigned int first = *(const unsigned int *)a;
+    unsigned int second = *(const unsigned int *)b;
+
+    return (first > second) - (first < second);
+
+}
+
+/**
+ * @brief Returns the nearest-rank percentile of a sorted array.
+ */
+static unsigned int percentile(unsigned int * sorted, unsigned int count,
+                               unsigned int percent) {
+
+    unsigned long rank = ((unsigned long)count * percent + 99) / 100;
+
+    return sorted[rank == 0 ? 0 : rank - 1];
+
+}
+
+/**
+ * @brief Computes the statistics of an array of results.
+ *
+ * @param results The results, which are sorted in place.
+ * @param count Number of results, at least one.
+ * @param stats Pointer to the structure that will store the statistics.
+ */
+static void summarizeResults(unsigned int * results, unsigned int count,
+                             MetricStats_t * stats) {
+
+    unsigned long long total = 0;
+    unsigned int i = 0;
+
+    qsort(results, count, sizeof(unsigned int), compareUnsigned);
+
+    for (i = 0; i < count; i++) {
+
+        total = total + results[i];
+
+    }
+
+    stats->mean = (double)total / count;
+    stats->p50 = percentile(results, count, 50);
+    stats->p95 = percentile(results, count, 95);
+    stats->p99 = percentile(results, count, 99);
+    stats->max = results[count - 1];
+
+}
+
+static void registerListener() {
+
+    setStateListener(updateMetrics);
+
+}
+
+void resetMetrics(MetricsCollector_t * metrics) {
+
+    int i = 0;
+
+    metrics->count = 0;
+    metrics->failed = 0;
+
+    for (i = 0; i < MAX_DEVICES; i++) {
+
+        metrics->devices[i].count = 0;
+
+    }
+
+    for (i = 0; i < MAX_LEVELS; i++) {
+
+        metrics->levels[i].count = 0;
+
+    }
+
+    pthread_once(&listenerOnce, registerListener);
+
+}
+
+void mergeMetrics(MetricsCollector_t * metrics, MetricsCollector_t * other) {
+
+    unsigned int i = 0;
+    int metric = 0;
+
+    for (i = 0; i < other->count; i++) {
+
+        if (metrics->count == metrics->capacity && growResults(metrics) != 0) {
+
+            return;
+
+        }
+
+        for (metric = 0; metric < METRICS; metric++) {
+
+            metrics->results[metric][metrics->count] = other->results[metric][i];
+
+        }
+
+        metrics->count = metrics->count + 1;
+
+    }
+
+    for (metric = 0; metric < MAX_DEVICES; metric++) {
+
+        for (i = 0; i < other->devices[metric].count; i++) {
+
+            recordLatency(metrics, metric,
+                          other->devices[metric].latencies[i]);
+
+        }
+
+    }
+
+    for (metric = 0; metric < MAX_LEVELS; metric++) {
+
+        for (i = 0; i < other->levels[metric].count; i++) {
+
+            recordLevelWait(metrics, metric, other->levels[metric].latencies[i]);
+
+        }
+
+    }
+
+}
+
+int summarizeMetrics(MetricsCollector_t * metrics, MetricsSummary_t * summary) {
+
+    unsigned int resultCount = metrics->count;
+    unsigned int * sorted = NULL;
+    int metric = 0;
+
+    memset(summary, 0, sizeof(MetricsSummary_t));
+
+    summary->tasks = resultCount;
+
+    // The latencies are not needed any more in arrival order, so they are
+    // sorted in place
+    for (metric = 0; metric < MAX_DEVICES; metric++) {
+
+        summary->requests[metric] = metrics->devices[metric].count;
+
+        if (metrics->devices[metric].count != 0) {
+
+            summarizeResults(metrics->devices[metric].latencies,
+                             metrics->devices[metric].count,
+                             &(summary->latency[metric]));
+
+        }
+
+    }
+
+    for (metric = 0; metric < MAX_LEVELS; metric++) {
+
+        summary->dispatches[metric] = metrics->levels[metric].count;
+
+        if (metrics->levels[metric].count != 0) {
+
+            summarizeResults(metrics->levels[metric].latencies,
+                             metrics->levels[metric].count,
+                             &(summary->levelWait[metric]));
+
+        }
+
+    }
+
+    if (resultCount == 0) {
+
+        return 0;
+
+    }
+
+    sorted = (unsigned int *)malloc(resultCount * sizeof(unsigned int));
+
+    if (sorted == NULL) {
+
+        perror("Not enough memory for the metrics");
+        return -1;
+
+    }
+
+    for (metric = 0; metric < METRICS; metric++) {
+
+        memcpy(sorted, metrics->results[metric], resultCount * sizeof(unsigned int));
+
+        summarizeResults(sorted, resultCount, &(summary->stats[metric]));
+
+    }
+
+    free(sorted);
+
+    return 0;
+
+}
+
+int printMetrics(MetricsCollector_t * metrics, Trace_t * trace) {
+
+    MetricsSummary_t summary;
+    int metric = 0;
+
+    if (summarizeMetrics(metrics, &summary) != 0) {
+
+        return -1;
+
+    }
+
+    tracePrintf(trace, "Finished tasks\t%u\n", summary.tasks);
+    tracePrintf(trace, "%-12s\t%10s\t%10s\t%10s\t%10s\t%10s\n",
+                "Metric", "Mean", "p50", "p95", "p99", "Max");
+
+    for (metric = 0; metric < METRICS; metric++) {
+
+        tracePrintf(trace, "%-12s\t%10.2f\t%10u\t%10u\t%10u\t%10u\n",
+                    metricNames[metric], summary.stats[metric].mean,
+                    summary.stats[metric].p50, summary.stats[metric].p95,
+                    summary.stats[metric].p99, summary.stats[metric].max);
+
+    }
+
+    return 0;
+
+}
+
+int printLatencies(MetricsCollector_t * metrics, const Device_t * devices,
+                   unsigned int count, Trace_t * trace) {
+
+    MetricsSummary_t summary;
+    const MetricStats_t * stats = NULL;
+    unsigned int i = 0;
+
+    if (count == 0) {
+
+        return 0;
+
+    }
+
+    if (summarizeMetrics(metrics, &summary) != 0) {
+
+        return -1;
+
+    }
+
+    tracePrintf(trace, "%-12s\t%10s\t%10s\t%10s\t%10s\t%10s\t%10s\n",
+                "I/O latency", "Requests", "Mean", "p50", "p95", "p99", "Max");
+
+    for (i = 0; i < count; i++) {
+
+        stats = &(summary.latency[i]);
+
+        tracePrintf(trace, "%-12s\t%10u\t%10.2f\t%10u\t%10u\t%10u\t%10u\n",
+                    devices[i].name, summary.requests[i], stats->mean,
+                    stats->p50, stats->p95, stats->p99, stats->max);
+
+    }
+
+    return 0;
+
+}
+
+int printLevels(MetricsCollector_t * metrics, unsigned int ticks,
+                Trace_t * trace) {
+
+    MetricsSummary_t summary;
+    const MetricStats_t * stats = NULL;
+    double queue = 0;
+    unsigned int i = 0, levels = 0;
+
+    if (summarizeMetrics(metrics, &summary) != 0) {
+
+        return -1;
+
+    }
+
+    // Only the levels up to the last one that has been used are printed
+    for (i = 0; i < MAX_LEVELS; i++) {
+
+        if (summary.dispatches[i] != 0) {
+
+            levels = i + 1;
+
+        }
+
+    }
+
+    if (levels == 0) {
+
+        return 0;
+
+    }
+
+    tracePrintf(trace, "%-12s\t%10s\t%10s\t%10s\t%10s\t%10s\t%10s\t%10s\n",
+                "Level", "Dispatches", "Queue", "Mean", "p50", "p95", "p99",
+                "Max");
+
+    for (i = 0; i < levels; i++) {
+
+        stats = &(summary.levelWait[i]);
+
+        // By Little's law, the mean length of the queue is the total wait
+        // of its tasks over the elapsed time
+        queue = ticks != 0 ? stats->mean * summary.dispatches[i] / ticks : 0;
+
+        tracePrintf(trace, "%-12u\t%10u\t%10.2f\t%10.2f\t%10u\t%10u\t%10u"
+                    "\t%10u\n", i, summary.dispatches[i], queue, stats->mean,
+                    stats->p50, stats->p95, stats->p99, stats->max);
+
+    }
+
+    return 0;
+
+}
+
+void printMetricsComparison(Trace_t * trace, const char * const * names,
+                            const MetricsSummary_t * summaries,
+                            const unsigned int * ticks, unsigned int count) {
+
+    static const char * statNames[] = { "mean", "p50", "p95", "p99", "max" };
+
+    const MetricStats_t * stats = NULL;
+    char label[32];
+    unsigned int i = 0;
+    int metric = 0, stat = 0;
+
+    tracePrintf(trace, "%-20s", "Metric");
+
+    for (i = 0; i < count; i++) {
+
+        tracePrintf(trace, "\t%12s", names[i]);
+
+    }
+
+    tracePrintf(trace, "\n%-20s", "Ticks");
+
+    for (i = 0; i < count; i++) {
+
+        tracePrintf(trace, "\t%12u", ticks[i]);
+
+    }
+
+    tracePrintf(trace, "\n%-20s", "Finished tasks");
+
+    for (i = 0; i < count; i++) {
+
+        tracePrintf(trace, "\t%12u", summaries[i].tasks);
+
+    }
+
+    tracePrintf(trace, "\n");
+
+    for (metric = 0; metric < METRICS; metric++) {
+
+        for (stat = 0; stat < 5; stat++) {
+
+            snprintf(label, sizeof(label), "%s %s", metricNames[metric],
+                     statNames[stat]);
+
+            tracePrintf(trace, "%-20s", label);
+
+            for (i = 0; i < count; i++) {
+
+                stats = &(summaries[i].stats[metric]);
+
+                switch (stat) {
+                case 0:
+                    tracePrintf(trace, "\t%12.2f", stats->mean);
+                    break;
+                case 1:
+                    tracePrintf(trace, "\t%12u", stats->p50);
+                    break;
+                case 2:
+                    tracePrintf(trace, "\t%12u", stats->p95);
+                    break;
+                case 3:
+                    tracePrintf(trace, "\t%12u", stats->p99);
+                    break;
+                default:
+                    tracePrintf(trace, "\t%12u", stats->max);
+                    break;
+                }
+
+            }
+
+            tracePrintf(trace, "\n");
+
+        }
+
+    }
+
+}
+
+void freeMetrics(MetricsCollector_t * metrics) {
+
+    int i = 0;
+
+    for (i = 0; i < METRICS; i++) {
+
+        free(metrics->results[i]);
+        metrics->results[i] = NULL;
+
+    }
+
+    for (i = 0; i < MAX_DEVICES; i++) {
+
+        free(metrics->devices[i].latencies);
+        metrics->devices[i].latencies = NULL;
+        metrics->devices[i].count = metrics->devices[i].capacity = 0;
+
+    }
+
+    for (i = 0; i < MAX_LEVELS; i++) {
+
+        free(metrics->levels[i].latencies);
+        metrics->levels[i].latencies = NULL;
+        metrics->levels[i].count = metrics->levels[i].capacity = 0;
+
+    }
+
+    metrics->count = metrics->capacity = 0;
+
+}
+
+const char * getMetricName(Metric_t metric) {
+
+    return metricNames[metric];
+
+}
+
+const char * getMetricKey(Metric_t metric) {
+
+    return metricKeys[metric];
+
+}
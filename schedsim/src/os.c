@@ -1,386 +1,1489 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <limits.h>
 
 #include <sched.h>
 #include <os.h>
-#include <descriptors.h>
+#include <simulator.h>
+#include <partition.h>
+
+/**
+ * @brief Returns the device shown in a column of the output
+ *
+ * Declared devices are shown in declaration order. The default ones are
+ * shown in reverse, keyboard first, as the simulator did before devices
+ * could be declared.
+ *
+ * @param sim Pointer to the simulator.
+ * @param column Index of the column, from 0 to the number of devices.
+ *
+ * @return Index of the device.
+ *
+ */
+static unsigned int shownDevice(Simulator_t * sim, unsigned int column) {
+
+    return sim->implicitDevices ? sim->deviceCount - 1 - column : column;
+
+}
+
+/**
+ * @brief Appends a queue to the status row being formatted
+ *
+ * @param sim Pointer to the simulator.
+ * @param queue Pointer to the queue.
+ *
+ */
+static void printQueue(Simulator_t * sim, TaskQueue_t * queue) {
+
+    PCB_t * pcb = NULL;
+
+    if (queue->size == 0) {
+
+        traceRowString(sim->trace, "(none)");
+
+    } else {
+
+        for (pcb = queue->first; pcb != NULL; pcb = pcb->next) {
+
+            traceRowString(sim->trace, pcb->command);
+
+            if (pcb->next != NULL) {
+
+                traceRowString(sim->trace, " -> ");
+
+            }
+        }
+    }
+
+}
+
+/**
+ * @brief Appends the tasks served by the channels of a device to the status
+ * row being formatted
+ *
+ * @param sim Pointer to the simulator.
+ * @param device Pointer to the device.
+ *
+ */
+static void printChannels(Simulator_t * sim, Device_t * device) {
+
+    unsigned int i = 0, printed = 0;
+
+    for (i = 0; i < device->channelCount; i++) {
+
+        if (device->channels[i].task != NULL) {
+
+            if (printed != 0) {
+
+                traceRowString(sim->trace, ", ");
+
+            }
+
+            traceRowString(sim->trace, device->channels[i].task->command);
+            printed = printed + 1;
+
+        }
+
+    }
+
+    if (printed == 0) {
+
+        traceRowString(sim->trace, "(none)");
+
+    }
+
+}
+
+/**
+ * @brief Prints the status of the system for a range of ticks
+ *
+ * The status row is only formatted if the trace mode requires any row of
+ * the range.
+ *
+ * @param sim Pointer to the simulator.
+ * @param first First tick of the range.
+ * @param count Number of ticks of the range.
+ * @param idle Non-zero if the state has not changed since the previous row.
+ *
+ */
+static void printStatus(Simulator_t * sim, unsigned int first,
+                        unsigned int count, int idle) {
+
+    Cpu_t * cpu = NULL;
+    Device_t * device = NULL;
+    unsigned int i = 0;
+
+    if (!traceRowsWanted(sim->trace, first, count, idle)) {
+
+        return;
+
+    }
+
+    traceBeginRow(sim->trace);
+
+    for (i = 0; i < sim->options.cpus; i++) {
+
+        cpu = &(sim->cpus[i]);
+
+        traceRowString(sim->trace,
+                       cpu->runningTask != NULL ? cpu->runningTask->command : "(none)");
+
+        traceRowString(sim->trace, "\t\t");
+
+        printQueue(sim, &(cpu->readyQueue));
+
+        traceRowString(sim->trace, "\t\t");
+
+    }
+
+    for (i = 0; i < sim->deviceCount; i++) {
+
+        device = &(sim->devices[shownDevice(sim, i)]);
+
+        if (i != 0) {
+
+            traceRowString(sim->trace, "\t\t");
+
+        }
+
+        printChannels(sim, device);
+
+        traceRowString(sim->trace, "\t\t");
+
+        printQueue(sim, &(device->waitingQueue));
+
+    }
+
+    traceEndRows(sim->trace, first, count);
+
+}
+
+/**
+ * @brief Logs the change of a slot to the binary trace
+ *
+ * @param sim Pointer to the simulator.
+ * @param slot The slot.
+ * @param pcb Pointer to the PCB of the task occupying the slot or NULL.
+ * @param tracedPID Pointer to the PID logged by the last event of the slot.
+ *
+ */
+static void traceSlot(Simulator_t * sim, TraceSlot_t slot, PCB_t * pcb,
+                      unsigned int * tracedPID) {
+
+    unsigned int pid = pcb != NULL ? pcb->PID : TRACE_NO_PID;
+
+    if (*tracedPID != pid) {
+
+        traceEvent(sim->trace, sim->clock, TRACE_EVENT_SLOT, pid, slot);
+        *tracedPID = pid;
+
+    }
+
+}
+
+/**
+ * @brief Logs the changes of the CPU slots and the device channels to the
+ * binary trace
+ *
+ * @param sim Pointer to the simulator.
+ *
+ */
+static void traceSlots(Simulator_t * sim) {
+
+    Cpu_t * cpu = NULL;
+    DeviceChannel_t * channel = NULL;
+    unsigned int i = 0, j = 0, pid = 0;
+
+    if (getTraceMode(sim->trace) != TRACE_BINARY) {
+
+        return;
+
+    }
+
+    for (i = 0; i < sim->options.cpus; i++) {
+
+        cpu = &(sim->cpus[i]);
+
+        traceSlot(sim, i == 0 ? TRACE_SLOT_CPU : TRACE_SLOT_CPUS + i - 1,
+                  cpu->runningTask, &(cpu->tracedPID));
+
+    }
+
+    for (i = 0; i < sim->deviceCount; i++) {
+
+        for (j = 0; j < sim->devices[i].channelCount; j++) {
+
+            channel = &(sim->devices[i].channels[j]);
+            pid = channel->task != NULL ? channel->task->PID : TRACE_NO_PID;
+
+            if (channel->tracedPID != pid) {
+
+                traceChannel(sim->trace, sim->clock, pid, i, j);
+                channel->tracedPID = pid;
+
+            }
+
+        }
+
+    }
+
+}
+
+void printSummary(Simulator_t * sim) {
+
+    double ticks = sim->clock != 0 ? sim->clock : 1;
+    unsigned long cpuBusyTicks = 0;
+    Device_t * device = NULL;
+    unsigned int i = 0;
+
+    for (i = 0; i < sim->options.cpus; i++) {
+
+        cpuBusyTicks = cpuBusyTicks + sim->cpus[i].busyTicks;
+
+    }
+
+    tracePrintf(sim->trace, "Ticks\t\t%u\n", sim->clock);
+    tracePrintf(sim->trace, "Tasks\t\t%u\n", sim->nextPID);
+    tracePrintf(sim->trace, "Unfinished\t%u\n", sim->livingTasks);
+
+    // The utilisation of the whole system is relative to the capacity of
+    // all the CPUs
+    tracePrintf(sim->trace, "CPU busy\t%lu (%.2f%%)\n", cpuBusyTicks,
+                100.0 * cpuBusyTicks / (ticks * sim->options.cpus));
+
+    if (sim->options.cpus > 1) {
+
+        for (i = 0; i < sim->options.cpus; i++) {
+
+            tracePrintf(sim->trace, "CPU%u busy\t%lu (%.2f%%)\n", i,
+                        sim->cpus[i].busyTicks,
+                        100.0 * sim->cpus[i].busyTicks / ticks);
+
+        }
+
+    }
+
+    // The utilisation of a device is relative to the capacity of all its
+    // channels too
+    for (i = 0; i < sim->deviceCount; i++) {
+
+        device = &(sim->devices[shownDevice(sim, i)]);
+
+        tracePrintf(sim->trace, "%s busy\t%lu (%.2f%%)\n", device->name,
+                    device->busyTicks,
+                    100.0 * device->busyTicks / (ticks * device->channelCount));
+
+    }
+
+}
+
+/**
+ * @brief Returns the load of a CPU
+ *
+ * The load of a CPU is the number of tasks that are running or ready to run
+ * on it.
+ *
+ * @param cpu Pointer to the CPU.
+ *
+ * @return The load of the CPU.
+ *
+ */
+static unsigned int cpuLoad(Cpu_t * cpu) {
+
+    return (cpu->runningTask != NULL ? 1 : 0) + cpu->readyQueue.size;
+
+}
+
+/**
+ * @brief Finds the least loaded CPU of a partition
+ *
+ * @param sim Pointer to the simulator.
+ * @param first First CPU of the partition.
+ * @param count Number of CPUs of the partition.
+ *
+ * @return The least loaded CPU. Ties are broken by the lowest CPU id.
+ *
+ */
+static unsigned int leastLoadedCpu(Simulator_t * sim, unsigned int first,
+                                   unsigned int count) {
+
+    unsigned int i = 0, best = first;
+
+    for (i = first + 1; i < first + count; i++) {
+
+        if (cpuLoad(&(sim->cpus[i])) < cpuLoad(&(sim->cpus[best]))) {
+
+            best = i;
+
+        }
+
+    }
+
+    return best;
+
+}
+
+/**
+ * @brief Moves the last ready task of a CPU to another CPU
+ *
+ * @param sim Pointer to the simulator.
+ * @param from The CPU the task is taken from.
+ * @param to The CPU the task is moved to.
+ *
+ */
+static void migrateReadyTask(Simulator_t * sim, unsigned int from,
+                             unsigned int to) {
+
+    // The tail of the queue is the task that would wait the longest
+    PCB_t * pcb = extractLast(&(sim->cpus[from].readyQueue));
+
+    pcb->cpu = to;
+
+    sim->options.policy->migrateTask(sim, to, pcb);
+
+}
+
+/**
+ * @brief Moves one task from the busiest CPU of a partition to the least
+ * loaded one
+ *
+ * @param sim Pointer to the simulator.
+ * @param first First CPU of the partition.
+ * @param count Number of CPUs of the partition.
+ *
+ * @return Non-zero if a task was moved.
+ *
+ */
+static int pushTask(Simulator_t * sim, unsigned int first, unsigned int count) {
+
+    unsigned int i = 0, busiest = first, least = first;
+
+    for (i = first + 1; i < first + count; i++) {
+
+        if (cpuLoad(&(sim->cpus[i])) > cpuLoad(&(sim->cpus[busiest]))) {
+
+            busiest = i;
+
+        }
+
+        if (cpuLoad(&(sim->cpus[i])) < cpuLoad(&(sim->cpus[least]))) {
+
+            least = i;
+
+        }
+
+    }
+
+    // A difference of one task cannot be improved
+    if (cpuLoad(&(sim->cpus[busiest])) <= cpuLoad(&(sim->cpus[least])) + 1 ||
+        sim->cpus[busiest].readyQueue.size == 0) {
+
+        return 0;
+
+    }
+
+    migrateReadyTask(sim, busiest, least);
+
+    return 1;
+
+}
+
+/**
+ * @brief Lets the first idle CPU of a partition steal a task from the
+ * longest ready queue of the partition
+ *
+ * @param sim Pointer to the simulator.
+ * @param first First CPU of the partition.
+ * @param count Number of CPUs of the partition.
+ *
+ * @return Non-zero if a task was stolen.
+ *
+ */
+static int stealTask(Simulator_t * sim, unsigned int first, unsigned int count) {
+
+    unsigned int i = 0, victim = first;
+
+    for (i = first + 1; i < first + count; i++) {
+
+        if (sim->cpus[i].readyQueue.size > sim->cpus[victim].readyQueue.size) {
+
+            victim = i;
+
+        }
+
+    }
+
+    if (sim->cpus[victim].readyQueue.size == 0) {
+
+        return 0;
+
+    }
+
+    for (i = first; i < first + count; i++) {
+
+        if (cpuLoad(&(sim->cpus[i])) == 0) {
+
+            migrateReadyTask(sim, victim, i);
+
+            return 1;
+
+        }
+
+    }
+
+    return 0;
+
+}
+
+/**
+ * @brief Balances the load of the CPUs
+ *
+ * Tasks are only moved between the CPUs of the same partition. The balancer
+ * moves tasks until no more moves are possible, so the state it leaves does
+ * not change until the next event. Otherwise the tick and the event engines
+ * would diverge.
+ *
+ * @param sim Pointer to the simulator.
+ *
+ */
+static void balanceLoad(Simulator_t * sim) {
+
+    unsigned int count = sim->options.cpus / sim->options.partitions;
+    unsigned int first = 0;
+
+    for (first = 0; first < sim->options.cpus; first += count) {
+
+        switch (sim->options.balancer) {
+        case BALANCE_PUSH:
+            while (pushTask(sim, first, count)) {
+            }
+            break;
+        case BALANCE_STEAL:
+            while (stealTask(sim, first, count)) {
+            }
+            break;
+        default:
+            break;
+        }
+
+    }
+
+}
+
+/**
+ * @brief Starts a task
+ *
+ * The task is placed on the least loaded CPU of its partition, the one it
+ * is pinned to or else the one given by its PID.
+ *
+ * @param sim Pointer to the simulator.
+ * @param pcb Pointer to the PCB of the task.
+ *
+ */
+static void startArrivingTask(Simulator_t * sim, PCB_t * pcb) {
+
+    unsigned int count = sim->options.cpus / sim->options.partitions;
+    unsigned int partition = 0, cpu = 0;
+
+    ((TaskDescriptor_t *)pcb)->sim = sim;
+
+    pcb->PID = sim->nextPID;
+    sim->nextPID = sim->nextPID + 1;
+
+    sim->livingTasks = sim->livingTasks + 1;
+
+    traceArrival(sim->trace, sim->clock, pcb->PID, pcb->command);
+
+    partition = getTaskPartition((TaskDescriptor_t *)pcb, pcb->PID,
+                                 sim->options.partitions);
+
+    cpu = leastLoadedCpu(sim, partition * count, count);
+
+    pcb->cpu = cpu;
+
+    sim->options.policy->startTask(sim, cpu, pcb);
+
+}
+
+/**
+ * @brief Removes a task from the system once its last burst has finished
+ *
+ * @param sim Pointer to the simulator.
+ * @param pcb Pointer to the PCB of the task.
+ *
+ */
+static void finishTask(Simulator_t * sim, PCB_t * pcb) {
+
+    unsigned int i = 0;
+
+    sim->livingTasks = sim->livingTasks - 1;
+
+    traceEvent(sim->trace, sim->clock, TRACE_EVENT_EXIT, pcb->PID, 0);
+
+    sim->options.policy->exitTask(sim, pcb->cpu, pcb);
+
+    // The source may reuse the memory of the task for a new one
+    for (i = 0; i < sim->deviceCount; i++) {
+
+        forgetDeviceService(&(sim->devices[i]), pcb);
+
+    }
+
+    // The scheduler is done with the task, so the source may free it
+    sim->source->release(sim->source, (TaskDescriptor_t *)pcb);
+
+}
+
+/**
+ * @brief Moves a task to its next burst
+ *
+ * @param desc Pointer to the descriptor of the task.
+ *
+ * @return Zero if the task has no more bursts, non-zero otherwise.
+ *
+ */
+static int nextBurst(TaskDescriptor_t * desc) {
+
+    desc->current = desc->current + 1;
+
+    if (desc->current >= desc->bursts.size) {
+
+        return 0;
+
+    }
+
+    desc->remainingTime = desc->bursts.durations[desc->current];
+
+    return 1;
+
+}
+
+/**
+ * @brief Consumes a tick of the current burst of a task
+ *
+ * @param desc Pointer to the descriptor of the task.
+ *
+ * @return Non-zero if the burst has ended.
+ *
+ */
+static int consumeBurstTick(TaskDescriptor_t * desc) {
+
+    // A burst of zero ticks ends on the first tick it is simulated
+    if (desc->remainingTime != 0) {
+
+        desc->remainingTime = desc->remainingTime - 1;
+
+    }
+
+    return desc->remainingTime == 0;
+
+}
+
+void simulateCpus(Simulator_t * sim) {
+
+    PCB_t * previousRunningTask = NULL;
+    TaskDescriptor_t * desc = NULL;
+    Cpu_t * cpu = NULL;
+    unsigned int i = 0, device = 0;
+
+    // On every CPU:
+    // 1. Check End Execuction Burst
+    // 2. Tick interrupt
+
+    for (i = 0; i < sim->options.cpus; i++) {
+
+        cpu = &(sim->cpus[i]);
+
+        previousRunningTask = cpu->runningTask;
+
+        if (previousRunningTask != NULL) {
+
+            cpu->busyTicks = cpu->busyTicks + 1;
+
+            desc = (TaskDescriptor_t *)previousRunningTask;
+
+            if (consumeBurstTick(desc)) {
+
+                if (!nextBurst(desc)) {
+
+                    cpu->runningTask = NULL;
+
+                    // If it was the last behaviour item -> exit task
+                    finishTask(sim, previousRunningTask);
+
+                } else if (desc->bursts.types[desc->current] != CPU) {
+
+                    cpu->runningTask = NULL;
+
+                    // If the next item is an I/O burst -> block
+                    device = desc->bursts.types[desc->current] - 1;
+
+                    sim->options.policy->yieldDevice(sim, i, device,
+                                                     previousRunningTask);
+
+                    requestDevice(sim, device, previousRunningTask);
+
+                } // else -> current type == CPU -> nothing
+
+            }
+
+        }
+
+        // Launch tick interrupt
+
+        if (cpu->runningTask != previousRunningTask) {
+
+            sim->options.policy->clockTick(sim, i, NULL);
+
+        } else {
+
+            sim->options.policy->clockTick(sim, i, cpu->runningTask);
+
+        }
+
+    }
+
+}
+
+/**
+ * @brief Moves the head of a device to the sector of the current burst of a
+ * task
+ *
+ * The seek of the head is added to the burst. The whole request, seek
+ * included, is the service the task receives from the device.
+ *
+ * @param sim Pointer to the simulator that owns the device.
+ * @param device Pointer to the device.
+ * @param desc Pointer to the descriptor of the task.
+ *
+ */
+static void moveHead(Simulator_t * sim, Device_t * device,
+                     TaskDescriptor_t * desc) {
+
+    uint32_t sector = getBurstSector(&(desc->bursts), desc->current);
+    unsigned long long seek = 0;
+
+    seek = sector > device->head ? sector - device->head :
+                                   device->head - sector;
+    seek = seek * device->seek;
+
+    if (seek > UINT_MAX - desc->remainingTime) {
+
+        seek = UINT_MAX - desc->remainingTime;
+
+    }
+
+    desc->remainingTime = desc->remainingTime + seek;
+
+    if (addDeviceService(device, (PCB_t *)desc, desc->remainingTime) != 0) {
+
+        sim->failed = 1;
+
+    }
 
-/** 
- * THE clock. Counts the number of ticks since the beginning of the 
- * execution
- */ 
-unsigned int clock;
+    device->head = sector;
 
-/** Next PID to be assigned */
-unsigned int nextPID;
+}
+
+/**
+ * @brief Starts serving a task on a free channel of a device
+ *
+ * @param sim Pointer to the simulator that owns the device.
+ * @param device Pointer to the device.
+ * @param channel Index of the free channel.
+ * @param pcb Pointer to the PCB of the task.
+ *
+ */
+static void startRequest(Simulator_t * sim, Device_t * device,
+                         unsigned int channel, PCB_t * pcb) {
+
+    TaskDescriptor_t * desc = (TaskDescriptor_t *)pcb;
+
+    device->channels[channel].task = pcb;
+    device->channels[channel].start = sim->clock;
+
+    device->busyChannels = device->busyChannels + 1;
+
+    moveHead(sim, device, desc);
+
+}
+
+void requestDevice(Simulator_t * sim, unsigned int device, PCB_t * pcb) {
+
+    Device_t * target = &(sim->devices[device]);
+    unsigned int channel = 0;
+
+    ((TaskDescriptor_t *)pcb)->requestTime = sim->clock;
+
+    if (target->busyChannels == target->channelCount) {
+
+        target->discipline->enqueue(target, pcb);
+
+        return;
+
+    }
 
-/** Number of tasks currenty living on the system */
-unsigned int livingTasks;
+    while (target->channels[channel].task != NULL) {
 
-/** Pointer to the task that is currently running */
-static PCB_t * runningTask;
+        channel = channel + 1;
 
-/** Pointer to the task that is currently using the hard disk */
-static PCB_t * hardDiskTask;
+    }
 
-/** Pointer to the task that is currently waiting for a keypress */
-static PCB_t * keyboardTask;
+    startRequest(sim, target, channel, pcb);
 
-/** THE ready queue */
-static TaskQueue_t privateReadyQueue;
-/** THE HD waiting queue */
-static TaskQueue_t privateHardDiskWaitingQueue;
-/** THE keyboard waiting queue */
-static TaskQueue_t privateKeyboardWaitingQueue;
+}
 
-/** 
- * These pointers are used so that students do not
- * need to use any pointer operator whatsoever
+/**
+ * @brief Handles the end of the I/O burst of a task
+ *
+ * The channel is given to the next waiting task right away, and the task
+ * moves on to its next burst. The interrupts are handled by the simulator
+ * the task belongs to, which may not own the devices.
+ *
+ * @param sim Pointer to the simulator that owns the device.
+ * @param device Index of the device.
+ * @param channel Index of the channel that served the task.
+ *
  */
+static void finishRequest(Simulator_t * sim, unsigned int device,
+                          unsigned int channel) {
 
-/** Pointer to the ready queue */
-TaskQueue_t * readyQueue;
-/** Pointer to the HD waiting queue */
-TaskQueue_t * hardDiskWaitingQueue;
-/** Pointer to the keyboard waiting queue */
-TaskQueue_t * keyboardWaitingQueue;
+    Device_t * source = &(sim->devices[device]);
+    PCB_t * pcb = source->channels[channel].task;
+    TaskDescriptor_t * desc = (TaskDescriptor_t *)pcb;
+    Simulator_t * owner = desc->sim;
+    PCB_t * waiting = NULL;
+    int more = 0;
 
-void printStatus() {
+    // The device accounts the latency of every request, from the tick it
+    // was issued until the end of its burst
+    recordLatency(&(sim->metrics), device, sim->clock - desc->requestTime);
 
-    PCB_t * ready = NULL;
-    PCB_t * keyboardWaiting = NULL;
-    PCB_t * hardDiskWaiting = NULL;
+    more = nextBurst(desc);
 
-    printf("%d\t%s\t\t", clock, runningTask != NULL ? runningTask->command : "(none)");
+    // Consecutive bursts on the same device are served as a single one,
+    // although every burst is still a request of its own
+    if (more && desc->bursts.types[desc->current] == device + 1) {
 
-    if (readyQueue->size == 0) {
+        desc->requestTime = sim->clock;
+        moveHead(sim, source, desc);
 
-        printf("(none)");
+        return;
 
-    } else {
+    }
 
-        for (ready = readyQueue->first; ready != NULL; ready = ready->next) {
+    source->channels[channel].task = NULL;
+    source->busyChannels = source->busyChannels - 1;
 
-            printf("%s", ready->command);
+    waiting = source->discipline->dequeue(source, sim->clock);
 
-            if (ready->next != NULL) {
+    if (waiting != NULL) {
 
-                printf(" -> ");
+        startRequest(sim, source, channel, waiting);
 
-            }
-        }
     }
 
-    printf("\t\t");
+    if (!more) {
+
+        // If it was the last behaviour item -> exit task
+        finishTask(owner, pcb);
 
-    if (keyboardTask == NULL) {
+    } else if (desc->bursts.types[desc->current] == CPU) {
 
-        printf("(none)");
+        // If the next item is CPU burst -> trigger IRQ
+        owner->options.policy->ioDeviceIRQ(owner, pcb->cpu, device, pcb);
 
     } else {
 
-        printf("%s", keyboardTask->command);
+        // If the next item is a burst on another device, the task goes
+        // straight there without going through the CPU
+        requestDevice(sim, desc->bursts.types[desc->current] - 1, pcb);
 
     }
 
-    printf("\t\t");
+}
 
-    if (keyboardWaitingQueue->size == 0) {
+void simulateDevices(Simulator_t * sim) {
 
-        printf("(none)");
+    Device_t * device = NULL;
+    DeviceChannel_t * channel = NULL;
+    unsigned int i = 0, j = 0;
 
-    } else {
+    // 3. End IO Bursts, device by device and channel by channel
+
+    for (i = 0; i < sim->deviceCount; i++) {
+
+        device = &(sim->devices[i]);
+
+        for (j = 0; j < device->channelCount; j++) {
+
+            channel = &(device->channels[j]);
+
+            // Tasks that started to use the channel on this tick, from a CPU
+            // or from the queue of the device, are served from the next one
+            if (channel->task == NULL || channel->start == sim->clock) {
+
+                continue;
 
-        for (keyboardWaiting = keyboardWaitingQueue->first; keyboardWaiting != NULL; keyboardWaiting = keyboardWaiting->next) {
+            }
 
-            printf("%s", keyboardWaiting->command);
+            device->busyTicks = device->busyTicks + 1;
 
-            if (keyboardWaiting->next != NULL) {
+            if (consumeBurstTick((TaskDescriptor_t *)channel->task)) {
 
-                printf(" -> ");
+                finishRequest(sim, i, j);
 
             }
+
         }
+
     }
 
-    printf("\t\t");
+}
 
-    if (hardDiskTask == NULL) {
+void finishTick(Simulator_t * sim) {
 
-        printf("(none)");
+    // 4. Start of a Task. Since the source delivers the tasks by start time,
+    // the arriving tasks are the ones at the arrival cursor
+    
+    while (sim->nextArrival != NULL &&
+           sim->nextArrival->startTime == sim->clock) {
 
-    } else {
+        startArrivingTask(sim, (PCB_t *)sim->nextArrival);
 
-        printf("%s", hardDiskTask->command);
+        sim->nextArrival = sim->source->next(sim->source);
 
     }
 
-    printf("\t\t");
+    // 5. Load balancing
+    balanceLoad(sim);
 
-    if (hardDiskWaitingQueue->size == 0) {
+}
 
-        printf("(none)");
+/**
+ * @brief Simulates a single clock tick
+ *
+ * This function advances the clock by one tick, updates the bursts of the
+ * tasks that are using the CPUs and the devices, launches the corresponding
+ * interrupts and starts the tasks whose start time has been reached.
+ *
+ * @param sim Pointer to the simulator.
+ *
+ */
+static void simulateTick(Simulator_t * sim) {
 
-    } else {
+    sim->clock = sim->clock + 1;
 
-        for (hardDiskWaiting = hardDiskWaitingQueue->first; hardDiskWaiting != NULL; hardDiskWaiting = hardDiskWaiting->next) {
+    simulateCpus(sim);
 
-            printf("%s", hardDiskWaiting->command);
+    simulateDevices(sim);
 
-            if (hardDiskWaiting->next != NULL) {
+    finishTick(sim);
 
-                printf(" -> ");
+}
+
+/**
+ * @brief Returns the remaining time of the current burst of a task
+ *
+ * @param pcb Pointer to the PCB of the task or NULL.
+ *
+ * @return The remaining time of the burst or UINT_MAX if pcb is NULL.
+ *
+ */
+static unsigned int remainingBurstTime(PCB_t * pcb) {
+
+    if (pcb == NULL) {
+
+        return UINT_MAX;
+
+    }
+
+    return ((TaskDescriptor_t *)pcb)->remainingTime;
+
+}
+
+unsigned int ticksToNextCpuEvent(Simulator_t * sim) {
+
+    unsigned int ticks = UINT_MAX;
+    unsigned int candidate = 0;
+    unsigned int i = 0;
+
+    for (i = 0; i < sim->options.cpus; i++) {
+
+        candidate = remainingBurstTime(sim->cpus[i].runningTask);
+        ticks = candidate < ticks ? candidate : ticks;
+
+        candidate = sim->options.policy->nextClockEvent(sim, i,
+                                                        sim->cpus[i].runningTask);
+        ticks = candidate < ticks ? candidate : ticks;
+
+    }
+
+    if (sim->nextArrival != NULL &&
+        sim->nextArrival->startTime - sim->clock < ticks) {
+
+        ticks = sim->nextArrival->startTime - sim->clock;
+
+    }
+
+    // A burst of zero ticks is only consumed when the tick is simulated
+    return ticks == 0 ? 1 : ticks;
+
+}
+
+/**
+ * @brief Computes the number of ticks until the next simulation event
+ *
+ * An event is a tick in which something may happen: a CPU or I/O burst
+ * ends, a new task arrives or the scheduler acts on its clockTick()
+ * function. Every tick before the next event is an idle tick in which the
+ * state of the system does not change.
+ *
+ * @param sim Pointer to the simulator.
+ *
+ * @return The number of ticks until the next event. It is always at least 1.
+ *
+ */
+static unsigned int ticksToNextEvent(Simulator_t * sim) {
+
+    unsigned int ticks = ticksToNextCpuEvent(sim);
+    unsigned int candidate = ticksToNextDeviceEvent(sim);
+
+    return candidate < ticks ? candidate : ticks;
+
+}
+
+unsigned int ticksToNextDeviceEvent(Simulator_t * sim) {
+
+    unsigned int ticks = UINT_MAX;
+    unsigned int candidate = 0;
+    unsigned int i = 0, j = 0;
+
+    for (i = 0; i < sim->deviceCount; i++) {
+
+        for (j = 0; j < sim->devices[i].channelCount; j++) {
+
+            candidate = remainingBurstTime(sim->devices[i].channels[j].task);
+            ticks = candidate < ticks ? candidate : ticks;
 
-            }
         }
+
     }
 
-    printf("\n");
+    // A burst of zero ticks is only consumed when the tick is simulated
+    return ticks == 0 ? 1 : ticks;
 
 }
 
-void runOS(TaskDescriptorList_t * list) {
+void skipCpuTicks(Simulator_t * sim, unsigned int ticks) {
 
-    int iterations = INT_MAX;
+    Cpu_t * cpu = NULL;
+    unsigned int i = 0;
 
-    PCB_t * pcb = NULL;
-    PCB_t * previousRunningTask = NULL;
-    PCB_t * previousHardDiskTask = NULL;
-    PCB_t * previousKeyboardTask = NULL;
+    for (i = 0; i < sim->options.cpus; i++) {
 
-    TaskDescriptor_t * desc = NULL;
+        cpu = &(sim->cpus[i]);
 
-    readyQueue = &privateReadyQueue;
-    hardDiskWaitingQueue = &privateHardDiskWaitingQueue;
-    keyboardWaitingQueue = &privateKeyboardWaitingQueue;
+        if (cpu->runningTask != NULL) {
 
-    livingTasks = list->size;
-    desc = list->first;
+            cpu->busyTicks = cpu->busyTicks + ticks;
+            ((TaskDescriptor_t *)cpu->runningTask)->remainingTime -= ticks;
 
-    printf("Time\tRunning\t\tReady\t\tKeyboard\tKbd Queue\tHard Disk\tHD Queue\n");
+        }
 
-    // Start all tasks that start at boot time
-    while (desc != NULL) {
+    }
+
+}
+
+/**
+ * @brief Skips a number of idle ticks
+ *
+ * This function consumes the given number of ticks from the bursts of the
+ * tasks that are using the CPUs and the devices. The scheduler keeps its
+ * timers on the clock, so it is not notified. The caller must guarantee that no event happens during those ticks.
+ *
+ * @param sim Pointer to the simulator.
+ * @param ticks Number of idle ticks to skip.
+ *
+ */
+static void skipIdleTicks(Simulator_t * sim, unsigned int ticks) {
+
+    skipCpuTicks(sim, ticks);
+
+    skipDeviceTicks(sim, ticks);
+
+}
+
+void skipDeviceTicks(Simulator_t * sim, unsigned int ticks) {
+
+    Device_t * device = NULL;
+    PCB_t * pcb = NULL;
+    unsigned int i = 0, j = 0;
+
+    for (i = 0; i < sim->deviceCount; i++) {
 
-        if (desc->startTime == 0) {
+        device = &(sim->devices[i]);
 
-            pcb = (PCB_t *)desc;
+        for (j = 0; j < device->channelCount; j++) {
 
-            pcb->PID = nextPID;
-            nextPID = nextPID + 1;
-            
-            startTask(pcb);
+            pcb = device->channels[j].task;
 
-            printStatus();
+            if (pcb != NULL) {
+
+                device->busyTicks = device->busyTicks + ticks;
+                ((TaskDescriptor_t *)pcb)->remainingTime -= ticks;
+
+            }
 
         }
 
-        desc = desc->next;
+    }
+
+}
+
+void initSimOptions(SimOptions_t * options) {
+
+    options->policy = getPolicies()[0];
+    options->engine = TICK_ENGINE;
+    options->quantum = DEFAULT_QUANTUM;
+    options->aging = 0;
+    options->levels = DEFAULT_LEVELS;
+    options->boost = 0;
+    options->cpus = 1;
+    options->balancer = BALANCE_PUSH;
+    options->partitions = 1;
+    options->threads = 1;
+
+}
+
+int initSimulator(Simulator_t * sim, const SimOptions_t * options,
+                  Trace_t * trace) {
+
+    memset(sim, 0, sizeof(Simulator_t));
+
+    sim->options = *options;
+    sim->trace = trace;
+
+    sim->cpus = (Cpu_t *)calloc(options->cpus, sizeof(Cpu_t));
+
+    if (sim->cpus == NULL) {
+
+        perror("Not enough memory for the CPUs");
+        return -1;
 
     }
 
-    while (livingTasks != 0 && iterations != 0) {
+    return 0;
 
-        clock = clock + 1;
+}
 
-        previousRunningTask = runningTask;
-        previousHardDiskTask = hardDiskTask;
-        previousKeyboardTask = keyboardTask;
+/**
+ * @brief Releases the devices of a simulator
+ *
+ * @param sim Pointer to the simulator.
+ *
+ */
+static void freeDevices(Simulator_t * sim) {
 
-        // EXECUTION
-        // 1. Check End Execuction Burst
-        // 2. Tick interrupt
-        // I/O
-        // 3. End IO Keyboard Burst
-        // 4. End IO Hard Disk Burst
-        // START NEW TASK
-        // 5. Start of a Task
+    unsigned int i = 0;
 
-        if (previousRunningTask != NULL) {
+    if (sim->ownDevices != NULL) {
 
-            desc = (TaskDescriptor_t *)previousRunningTask;
-            desc->current->remainingTime = desc->current->remainingTime - 1;
+        for (i = 0; i < sim->deviceCount; i++) {
 
-            if (desc->current->remainingTime == 0) {
+            free(sim->ownDevices[i].channels);
+            free(sim->ownDevices[i].services);
 
-                desc->current = desc->current->next;
+        }
 
-                if (desc->current == NULL) {
+    }
 
-                    runningTask = NULL;
+    free(sim->ownDevices);
 
-                    // If it was the last behaviour item -> exit task
-                    livingTasks = livingTasks - 1;
-                    exitTask(previousRunningTask);
+    sim->ownDevices = NULL;
+    sim->devices = NULL;
+    sim->deviceCount = 0;
 
-                } else if (desc->current->type == IO_HARD_DISK) {
+}
 
-                    runningTask = NULL;
+/**
+ * @brief Builds the devices of a simulator from a device table
+ *
+ * @param sim Pointer to the simulator.
+ * @param table Pointer to the device table.
+ *
+ * @return 0 on success, -1 if there is not enough memory. The simulator is
+ * then left without devices.
+ *
+ */
+static int buildDevices(Simulator_t * sim, const DeviceTable_t * table) {
 
-                    // If the next item is a hard disk burst -> block
-                    yieldHardDisk(previousRunningTask);
+    Device_t * device = NULL;
+    unsigned int i = 0;
 
-                } else if (desc->current->type == IO_KEYBOARD) {
+    freeDevices(sim);
 
-                    runningTask = NULL;
+    if (table->size != 0) {
 
-                    // If the next item is a keyboard burst -> block
-                    yieldKeyboard(previousRunningTask);
+        sim->ownDevices = (Device_t *)calloc(table->size, sizeof(Device_t));
 
-                } // else -> current->type == CPU -> nothing
+        if (sim->ownDevices == NULL) {
 
-            }
+            perror("Not enough memory for the devices");
+            return -1;
 
         }
-        
-        // Launch tick interrupt
-        
-        if (runningTask != previousRunningTask) {
 
-            clockTick(NULL);
+    }
+
+    sim->devices = sim->ownDevices;
+    sim->deviceCount = table->size;
+    sim->implicitDevices = table->implicit;
 
-        } else {
+    for (i = 0; i < table->size; i++) {
+
+        device = &(sim->devices[i]);
+
+        device->name = table->devices[i].name;
+        device->index = i;
+        device->discipline = table->devices[i].discipline;
+        device->deadline = table->devices[i].deadline;
+        device->seek = table->devices[i].seek;
+        device->channelCount = table->devices[i].channels;
 
-            clockTick(runningTask);
+        device->channels = (DeviceChannel_t *)calloc(device->channelCount,
+                                                     sizeof(DeviceChannel_t));
+
+        if (device->channels == NULL) {
+
+            perror("Not enough memory for the devices");
+            freeDevices(sim);
+            return -1;
 
         }
 
-        // Launch IO Hard Disk interrupt
-        
-        if (previousHardDiskTask != NULL) {
+    }
+
+    return 0;
 
-            desc = (TaskDescriptor_t *)previousHardDiskTask;
-            desc->current->remainingTime = desc->current->remainingTime - 1;
+}
 
-            if (desc->current->remainingTime == 0) {
+void freeSimulator(Simulator_t * sim) {
 
-                desc->current = desc->current->next;
+    freeMetrics(&(sim->metrics));
 
-                if (desc->current == NULL) {
-                    
-                    hardDiskTask = NULL;
+    freeDevices(sim);
 
-                    // If it was the last behaviour item -> exit task
-                    livingTasks = livingTasks - 1;
-                    exitTask(previousHardDiskTask);
+    free(sim->cpus);
 
-                } else if (desc->current->type == CPU) {
+}
 
-                    // If the next item is CPU burst -> trigger IRQ
-                    hardDiskTask = NULL;
-                    ioHardDiskIRQ(previousHardDiskTask);
+int runOS(Simulator_t * sim, TaskDescriptorList_t * list) {
 
-                } else if (desc->current->type == IO_KEYBOARD) {
+    ListSource_t listSource;
 
-                    // If the next item is a keyboard burst -> block
-                    keyboardTask = NULL;
-                    yieldKeyboard(previousHardDiskTask);
+    openListSource(&listSource, list);
 
-                } // else -> current->type == IO_HARD_DISK -> nothing
+    return runOSFromSource(sim, &(listSource.source));
 
-            }
+}
+
+int resetSimulator(Simulator_t * sim, TaskSource_t * source) {
+
+    unsigned int i = 0, j = 0;
+
+    sim->clock = 0;
+    sim->nextPID = 0;
+    sim->livingTasks = 0;
+    sim->failed = 0;
+
+    for (i = 0; i < sim->options.cpus; i++) {
+
+        sim->cpus[i].runningTask = NULL;
+        sim->cpus[i].dispatchTime = 0;
+        sim->cpus[i].tracedPID = TRACE_NO_PID;
+        sim->cpus[i].busyTicks = 0;
+
+        initQueue(&(sim->cpus[i].readyQueue));
+
+    }
+
+    if (buildDevices(sim, source->devices) != 0) {
+
+        return -1;
+
+    }
+
+    for (i = 0; i < sim->deviceCount; i++) {
+
+        for (j = 0; j < sim->devices[i].channelCount; j++) {
+
+            sim->devices[i].channels[j].tracedPID = TRACE_NO_PID;
 
         }
 
-        // Launch IO Keboard interrupt
-        
-        if (previousKeyboardTask != NULL) {
+        initQueue(&(sim->devices[i].waitingQueue));
 
-            desc = (TaskDescriptor_t *)previousKeyboardTask;
-            desc->current->remainingTime = desc->current->remainingTime - 1;
+    }
+
+    sim->source = source;
+    sim->nextArrival = source->next(source);
 
-            if (desc->current->remainingTime == 0) {
+    resetMetrics(&(sim->metrics));
 
-                desc->current = desc->current->next;
+    return 0;
 
-                if (desc->current == NULL) {
+}
 
-                    keyboardTask = NULL;
+int simulationFailed(Simulator_t * sim) {
 
-                    // If it was the last behaviour item -> exit task
-                    livingTasks = livingTasks - 1;
-                    exitTask(previousKeyboardTask);
+    return sim->failed || sim->metrics.failed || hasTraceFailed(sim->trace);
+
+}
+
+void startBootTasks(Simulator_t * sim) {
+
+    while (sim->nextArrival != NULL && sim->nextArrival->startTime == 0) {
 
-                } else if (desc->current->type == CPU) {
+        startArrivingTask(sim, (PCB_t *)sim->nextArrival);
 
-                    // If the next item is a CPU burst -> trigger IRQ
-                    keyboardTask = NULL;
-                    ioKeyboardIRQ(previousKeyboardTask);
+        balanceLoad(sim);
 
-                } else if (desc->current->type == IO_HARD_DISK) {
+        printStatus(sim, sim->clock, 1, 0);
+        traceSlots(sim);
+
+        sim->nextArrival = sim->source->next(sim->source);
+
+    }
+
+}
+
+int runOSFromSource(Simulator_t * sim, TaskSource_t * source) {
+
+    int iterations = INT_MAX;
+    unsigned int idleTicks = 0;
+    unsigned int i = 0;
+
+    // The rows and the binary trace need the state of the whole system on
+    // every tick, which the parallel engine never builds
+    if (sim->options.engine == PARALLEL_ENGINE &&
+        getTraceMode(sim->trace) == TRACE_OFF) {
+
+        return runPartitions(sim, source);
+
+    }
+
+    // Start from a clean system, so that the same list of descriptors can be
+    // simulated several times
+    if (resetSimulator(sim, source) != 0) {
+
+        return -1;
+
+    }
+
+    if (traceRowsWanted(sim->trace, 0, 1, 0)) {
+
+        if (sim->options.cpus == 1) {
+
+            tracePrintf(sim->trace, "Time\tRunning\t\tReady\t\t");
+
+        } else {
+
+            tracePrintf(sim->trace, "Time\t");
+
+            for (i = 0; i < sim->options.cpus; i++) {
+
+                tracePrintf(sim->trace, "CPU%u\t\tReady%u\t\t", i, i);
+
+            }
+
+        }
+
+        if (sim->implicitDevices) {
+
+            tracePrintf(sim->trace,
+                        "Keyboard\tKbd Queue\tHard Disk\tHD Queue");
+
+        } else {
 
-                    // If the next item is a hard disk burst -> block
-                    keyboardTask = NULL;
-                    yieldHardDisk(previousKeyboardTask);
+            for (i = 0; i < sim->deviceCount; i++) {
 
-                } // else -> current->type == IO_KEYBOARD -> nothing
+                tracePrintf(sim->trace, "%s%s%s\tQueue",
+                            i != 0 ? "\t\t" : "", sim->devices[i].name,
+                            strlen(sim->devices[i].name) < 8 ? "\t" : "");
 
             }
 
         }
 
-        // Check if a new task starts
-        
-        desc = list->first;
+        tracePrintf(sim->trace, "\n");
 
-        // Start all tasks that start at boot time
-        while (desc != NULL) {
+    }
+
+    // The binary trace names the devices before any of their events
+    for (i = 0; i < sim->deviceCount; i++) {
+
+        traceDevice(sim->trace, i, sim->devices[i].channelCount,
+                    sim->devices[i].name);
+
+    }
+
+    // Start all tasks that start at boot time
+    startBootTasks(sim);
+
+    while ((sim->livingTasks != 0 || sim->nextArrival != NULL) &&
+           iterations != 0 && !simulationFailed(sim)) {
 
-            if (desc->startTime == clock) {
+        if (sim->options.engine != TICK_ENGINE) {
 
-                pcb = (PCB_t *)desc;
+            // Jump straight to the tick of the next event. The state does
+            // not change during the idle ticks, so they are only printed
+            idleTicks = ticksToNextEvent(sim) - 1;
 
-                pcb->PID = nextPID;
-                nextPID = nextPID + 1;
-                
-                startTask(pcb);
+            if (idleTicks > (unsigned int)iterations) {
+
+                idleTicks = iterations;
 
             }
 
-            desc = desc->next;
+            skipIdleTicks(sim, idleTicks);
+
+            printStatus(sim, sim->clock + 1, idleTicks, 1);
+
+            sim->clock = sim->clock + idleTicks;
+            iterations = iterations - idleTicks;
+
+            if (iterations == 0) {
+
+                break;
+
+            }
 
         }
 
-        printStatus();
+        simulateTick(sim);
+
+        printStatus(sim, sim->clock, 1, 0);
+        traceSlots(sim);
 
         iterations = iterations - 1;
 
     }
 
+    // The tasks that never arrived are unfinished too
+    while (sim->nextArrival != NULL) {
+
+        sim->livingTasks = sim->livingTasks + 1;
+
+        source->release(source, sim->nextArrival);
+        sim->nextArrival = source->next(source);
+
+    }
+
+    return simulationFailed(sim) ? -1 : 0;
+
+}
+
+void dispatch(Simulator_t * sim, unsigned int cpu, PCB_t * pcb) {
+
+    sim->cpus[cpu].runningTask = pcb;
+    sim->cpus[cpu].dispatchTime = sim->clock;
+
+    if (pcb != NULL) {
+
+        pcb->cpu = cpu;
+
+    }
+
+}
+
+unsigned int getClock(Simulator_t * sim) {
+
+    return sim->clock;
+
+}
+
+unsigned int getCpuCount(Simulator_t * sim) {
+
+    return sim->options.cpus;
+
+}
+
+PCB_t * getRunningTask(Simulator_t * sim, unsigned int cpu) {
+
+    return sim->cpus[cpu].runningTask;
+
+}
+
+unsigned int getQuantum(Simulator_t * sim) {
+
+    return sim->options.quantum;
+
+}
+
+unsigned int getTaskQuantum(Simulator_t * sim, PCB_t * pcb) {
+
+    TaskDescriptor_t * desc = (TaskDescriptor_t *)pcb;
+
+    return desc->quantum != 0 ? desc->quantum : sim->options.quantum;
+
+}
+
+unsigned int getBurstRemaining(Simulator_t * sim, PCB_t * pcb) {
+
+    return ((TaskDescriptor_t *)pcb)->remainingTime;
+
+}
+
+unsigned int getDispatchTime(Simulator_t * sim, unsigned int cpu) {
+
+    return sim->cpus[cpu].dispatchTime;
+
 }
 
-void dispatch(PCB_t * pcb) {
+unsigned int getAging(Simulator_t * sim) {
 
-    runningTask = pcb;
+    return sim->options.aging;
 
 }
 
-void programHardDisk(PCB_t * pcb) {
+unsigned int getBasePriority(Simulator_t * sim, PCB_t * pcb) {
 
-    hardDiskTask = pcb;
+    return ((TaskDescriptor_t *)pcb)->priority;
 
 }
 
-void programKeyboard(PCB_t * pcb) {
+unsigned int getLevels(Simulator_t * sim) {
 
-    keyboardTask = pcb;
+    return sim->options.levels;
 
 }
 
-PCB_t * getRunningTask() {
+unsigned int getBoost(Simulator_t * sim) {
 
-    return runningTask;
+    return sim->options.boost;
 
 }
 
-PCB_t * getHardDiskWaitingTask() {
+void recordLevelDispatch(Simulator_t * sim, unsigned int level, PCB_t * pcb) {
+
+    TaskDescriptor_t * desc = (TaskDescriptor_t *)pcb;
+    unsigned int wait = 0;
+
+    // A task that has just arrived has not waited at all
+    if (getState(pcb) == READY) {
+
+        wait = sim->clock - desc->metrics.lastTransition;
+
+    }
 
-    return hardDiskTask;
+    recordLevelWait(&(sim->metrics), level, wait);
 
 }
 
-PCB_t * getKeyboardWaitingTask() {
+TaskQueue_t * getReadyQueue(Simulator_t * sim, unsigned int cpu) {
 
-    return keyboardTask;
+    return &(sim->cpus[cpu].readyQueue);
 
 }
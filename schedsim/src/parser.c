@@ -1,6 +1,9 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
+#include <limits.h>
+#include <pthread.h>
 #include <sys/mman.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -9,83 +12,194 @@
 
 #include <parser.h>
 
+/**
+ * Average number of bytes of the file per JSON token, used to size the
+ * initial token buffer. It underestimates the number of tokens of typical
+ * descriptor files, so the buffer grows at most a couple of times.
+ */
+#define TOKEN_BYTES_ESTIMATE 16
+
+/**
+ * Minimum number of bytes of tasks parsed by every thread. Smaller files
+ * are not worth the threads.
+ */
+#define PARSE_CHUNK_MIN (256 * 1024)
+
+/**
+ * Returned instead of a number of tokens or a position in the file when the
+ * file is malformed. Every element is at least one token long, and none of
+ * the returned positions can be the first character of the file.
+ */
+#define PARSE_FAILED 0
+
 /**
  * @brief Parse a string token from a JSON file.
  *
+ * @param arena The arena where the string is stored.
  * @param descriptors The string containing the contents of the JSON file.
  * @param tokens Pointer to the token identifier of the string to be parsed.
  *
- * @return The parsed string. The memory that stores the string is
- *         dynamically allocted.
+ * @return The parsed string or NULL if there is not enough memory. The
+ *         memory that stores the string belongs to the arena.
  *
  */
-char *parseString(char *descriptors, jsmntok_t *tokens) {
+char *parseString(Arena_t *arena, char *descriptors, jsmntok_t *tokens) {
+
+    // Copy the string from the file to the arena, adding the EOS character
+    return arenaStrndup(arena, descriptors + tokens[0].start,
+                        tokens[0].end - tokens[0].start);
+}
 
-    int length = 0;
-    char *tmpString = NULL;
+/**
+ * @brief Checks whether eight consecutive characters are all decimal digits.
+ *
+ * The characters are packed in a 64-bit word, so the eight of them are
+ * checked at once: every byte must have the high nibble 0x3 and must stay
+ * below 0x3a when 6 is added to it.
+ *
+ * @param chunk The eight characters, in memory order.
+ *
+ * @return Non-zero if all of them are digits.
+ *
+ */
+static int isEightDigits(uint64_t chunk) {
 
-    // Size of the memory chunk to be allocated = size of the string + '\0'
-    length = tokens[0].end - tokens[0].start + 1;
+    return (chunk & 0xf0f0f0f0f0f0f0f0ULL) == 0x3030303030303030ULL &&
+           ((chunk + 0x0606060606060606ULL) & 0xf0f0f0f0f0f0f0f0ULL) ==
+               0x3030303030303030ULL;
+}
 
-    tmpString = (char *)malloc(length);
+/**
+ * @brief Converts eight decimal digits packed in a 64-bit word.
+ *
+ * The first digit must be in the lowest byte, which is the memory order on
+ * little-endian machines. Adjacent digits are combined in pairs, then in
+ * groups of four and finally in a single group of eight.
+ *
+ * @param chunk The eight digits, already validated.
+ *
+ * @return The value of the digits.
+ *
+ */
+static uint32_t parseEightDigits(uint64_t chunk) {
 
-    // Copy the string from the file to the buffer
-    strncpy(tmpString, descriptors + tokens[0].start, length - 1);
+    const uint64_t mask = 0x000000ff000000ffULL;
+    const uint64_t mul1 = 100 + (1000000ULL << 32);
+    const uint64_t mul2 = 1 + (10000ULL << 32);
 
-    // Add the EOS character
-    tmpString[length - 1] = '\0';
+    chunk = chunk - 0x3030303030303030ULL;
+    chunk = (chunk * 10) + (chunk >> 8);
+    chunk = ((chunk & mask) * mul1 + ((chunk >> 16) & mask) * mul2) >> 32;
 
-    return tmpString;
+    return (uint32_t)chunk;
 }
 
 /**
  * @brief Parse a decimal number from a JSON file.
  *
+ * The digits are read straight from the contents of the file, without
+ * copying the token. Only plain unsigned integers that fit in an unsigned
+ * int are accepted. On little-endian machines, runs of eight digits are
+ * validated and converted at once.
+ *
  * @param descriptors The string containing the contents of the JSON file.
  * @param tokens Pointer to the token identifier of the decimal number to be
  * parsed.
+ * @param value Pointer where the parsed decimal number is stored.
  *
- * @return The parsed decimal number.
+ * @return 0 on success, -1 if the token is not a valid decimal number.
  *
  */
-unsigned long parseDecimal(char *descriptors, jsmntok_t *tokens) {
+int parseDecimal(char *descriptors, jsmntok_t *tokens, unsigned long *value) {
+
+    const char *digit = descriptors + tokens[0].start;
+    const char *end = descriptors + tokens[0].end;
+    unsigned long long result = 0;
+    uint64_t chunk = 0;
 
-    int length = 0;
-    char *tmpString = NULL, *endString = NULL;
-    unsigned long result = 0;
+    if (digit == end) {
+
+        fprintf(stderr, "Invalid decimal integer at: %d\n", tokens->start);
+        return -1;
+    }
 
-    length = tokens[0].end - tokens[0].start + 1;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    while (end - digit >= 8) {
 
-    tmpString = (char *)malloc(length);
+        memcpy(&chunk, digit, sizeof(chunk));
 
-    strncpy(tmpString, descriptors + tokens[0].start, length - 1);
+        if (!isEightDigits(chunk)) {
 
-    tmpString[length - 1] = '\0';
+            break;
+        }
 
-    result = strtoul(tmpString, &endString, 10);
+        result = result * 100000000ULL + parseEightDigits(chunk);
 
-    if (*endString != '\0') {
+        if (result > UINT_MAX) {
 
-        fprintf(stderr, "Invalid decimal integer at: %d\n", tokens->start);
-        exit(-1);
+            fprintf(stderr, "Decimal integer out of range at: %d\n",
+                    tokens->start);
+            return -1;
+        }
+
+        digit = digit + 8;
     }
+#endif
 
-    free(tmpString);
+    for (; digit < end; digit++) {
 
-    return result;
+        if (*digit < '0' || *digit > '9') {
+
+            fprintf(stderr, "Invalid decimal integer at: %d\n", tokens->start);
+            return -1;
+        }
+
+        result = result * 10 + (*digit - '0');
+
+        if (result > UINT_MAX) {
+
+            fprintf(stderr, "Decimal integer out of range at: %d\n",
+                    tokens->start);
+            return -1;
+        }
+    }
+
+    *value = result;
+
+    return 0;
+}
+
+/**
+ * @brief Checks whether a token is the key of a given field.
+ *
+ * @return Non-zero if the token is a string with the name of the field.
+ *
+ */
+static int isField(char *descriptors, jsmntok_t *token, const char *name) {
+
+    return token->type == JSMN_STRING && token->size == 1 &&
+           (size_t)(token->end - token->start) == strlen(name) &&
+           strncmp(name, descriptors + token->start, strlen(name)) == 0;
 }
 
 unsigned int parseStartTime(TaskDescriptor_t *desc, char *descriptors,
                             jsmntok_t *tokens) {
 
+    unsigned long value = 0;
+
     if (tokens[0].type == JSMN_PRIMITIVE && tokens[0].size == 0) {
 
-        desc->startTime = parseDecimal(descriptors, tokens);
+        if (parseDecimal(descriptors, tokens, &value) != 0) {
+
+            return PARSE_FAILED;
+        }
+
+        desc->startTime = value;
 
     } else {
 
         fprintf(stderr, "Invalid start time value at: %d\n", tokens->start);
-        exit(-1);
+        return PARSE_FAILED;
     }
 
     return 1;
@@ -94,111 +208,198 @@ unsigned int parseStartTime(TaskDescriptor_t *desc, char *descriptors,
 unsigned int parsePriority(TaskDescriptor_t *desc, char *descriptors,
                             jsmntok_t *tokens) {
 
+    unsigned long value = 0;
+
     if (tokens[0].type == JSMN_PRIMITIVE && tokens[0].size == 0) {
 
-        desc->pcb.priority = parseDecimal(descriptors, tokens);
+        if (parseDecimal(descriptors, tokens, &value) != 0) {
+
+            return PARSE_FAILED;
+        }
+
+        desc->priority = value;
 
     } else {
 
         fprintf(stderr, "Invalid priority value at: %d\n", tokens->start);
-        exit(-1);
+        return PARSE_FAILED;
+    }
+
+    return 1;
+}
+
+unsigned int parseQuantum(TaskDescriptor_t *desc, char *descriptors,
+                          jsmntok_t *tokens) {
+
+    unsigned long quantum = 0;
+
+    // A quantum of 0 would mean the quantum of the simulation, so it must
+    // be given explicitly as a positive number
+    if (tokens[0].type == JSMN_PRIMITIVE && tokens[0].size == 0 &&
+        parseDecimal(descriptors, tokens, &quantum) != 0) {
+
+        return PARSE_FAILED;
+    }
+
+    if (quantum == 0) {
+
+        fprintf(stderr, "Invalid quantum value at: %d\n", tokens->start);
+        return PARSE_FAILED;
+    }
+
+    desc->quantum = quantum;
+
+    return 1;
+}
+
+unsigned int parsePartition(TaskDescriptor_t *desc, char *descriptors,
+                            jsmntok_t *tokens) {
+
+    unsigned long partition = ANY_PARTITION;
+
+    if (tokens[0].type == JSMN_PRIMITIVE && tokens[0].size == 0 &&
+        parseDecimal(descriptors, tokens, &partition) != 0) {
+
+        return PARSE_FAILED;
+    }
+
+    if (partition == ANY_PARTITION) {
+
+        fprintf(stderr, "Invalid partition value at: %d\n", tokens->start);
+        return PARSE_FAILED;
     }
 
+    desc->partition = partition;
+
     return 1;
 }
 
-unsigned int parseBehaviourDuration(TaskBehaviour_t *behaviour,
+unsigned int parseBehaviourDuration(TaskBursts_t *bursts, unsigned int index,
                                     char *descriptors, jsmntok_t *tokens) {
 
+    unsigned long duration = 0;
+
     if (tokens[0].type == JSMN_PRIMITIVE && tokens[0].size == 0) {
 
-        behaviour->remainingTime = parseDecimal(descriptors, tokens);
+        if (parseDecimal(descriptors, tokens, &duration) != 0) {
+
+            return PARSE_FAILED;
+        }
+
+        bursts->durations[index] = duration;
 
     } else {
 
         fprintf(stderr, "Invalid duration time value at: %d\n", tokens->start);
-        exit(-1);
+        return PARSE_FAILED;
     }
 
     return 1;
 }
 
-unsigned int parseBehaviourType(TaskBehaviour_t *behaviour, char *descriptors,
+unsigned int parseBehaviourType(TaskBursts_t *bursts, unsigned int index,
+                                unsigned int devices, char *descriptors,
                                 jsmntok_t *tokens) {
 
-    TaskBehaviourType_t type = 0;
+    unsigned long type = 0;
+
+    // Type 0 is a CPU burst and type n > 0 a burst on device n - 1
 
     if (tokens[0].type == JSMN_PRIMITIVE && tokens[0].size == 0) {
 
-        type = parseDecimal(descriptors, tokens);
+        if (parseDecimal(descriptors, tokens, &type) != 0) {
 
-        if (type != CPU && type != IO_HARD_DISK && type != IO_KEYBOARD) {
+            return PARSE_FAILED;
+        }
 
-            fprintf(
-                stderr,
-                "Invalid behaviour type at: %d\n, valid values are 0, 1 or 2",
-                tokens->start);
-            exit(-1);
+        if (type > devices) {
+
+            fprintf(stderr, "Invalid behaviour type at: %d, valid values "
+                            "are 0 to %u\n", tokens->start, devices);
+            return PARSE_FAILED;
         }
 
-        behaviour->type = type;
+        bursts->types[index] = type;
 
     } else {
 
-        fprintf(stderr,
-                "Invalid behaviour type at: %d\n, valid values are 0, 1 or 2",
-                tokens->start);
-        exit(-1);
+        fprintf(stderr, "Invalid behaviour type at: %d, valid values are 0 "
+                        "to %u\n", tokens->start, devices);
+        return PARSE_FAILED;
     }
 
     return 1;
 }
 
-unsigned int parseCommand(TaskDescriptor_t *desc, char *descriptors,
-                          jsmntok_t *tokens) {
+unsigned int parseBehaviourSector(Arena_t *arena, TaskBursts_t *bursts,
+                                  unsigned int index, char *descriptors,
+                                  jsmntok_t *tokens) {
+
+    unsigned long sector = 0;
+
+    if (tokens[0].type != JSMN_PRIMITIVE || tokens[0].size != 0) {
+
+        fprintf(stderr, "Invalid sector value at: %d\n", tokens->start);
+        return PARSE_FAILED;
+    }
+
+    if (parseDecimal(descriptors, tokens, &sector) != 0) {
+
+        return PARSE_FAILED;
+    }
+
+    // Most tasks do not give any sector, so the array is only allocated
+    // once one of their bursts does
+    if (bursts->sectors == NULL && allocTaskSectors(bursts, arena) != 0) {
+
+        return PARSE_FAILED;
+    }
+
+    bursts->sectors[index] = sector;
+
+    return 1;
+}
+
+unsigned int parseCommand(Arena_t *arena, TaskDescriptor_t *desc,
+                          char *descriptors, jsmntok_t *tokens) {
 
     if (tokens[0].type == JSMN_STRING && tokens[0].size == 0) {
 
-        desc->pcb.command = parseString(descriptors, tokens);
+        desc->pcb.command = parseString(arena, descriptors, tokens);
+
+        if (desc->pcb.command == NULL) {
+
+            return PARSE_FAILED;
+        }
 
     } else {
 
         fprintf(stderr, "Invalid command value at: %d\n", tokens->start);
-        exit(-1);
+        return PARSE_FAILED;
     }
 
     return 1;
 }
 
-unsigned int parseBehaviour(TaskDescriptor_t *desc, char *descriptors,
-                            jsmntok_t *tokens) {
+unsigned int parseBehaviour(Arena_t *arena, TaskBursts_t *bursts,
+                            unsigned int index, unsigned int devices,
+                            char *descriptors, jsmntok_t *tokens) {
 
-    TaskBehaviour_t *behaviour = NULL;
-    unsigned int currPtr = 0;
-    int foundType = 0, foundDuration = 0;
+    unsigned int currPtr = 0, consumed = 0;
+    int foundType = 0, foundDuration = 0, foundSector = 0;
 
-    if (tokens->size != 2) {
+    if (tokens->size != 2 && tokens->size != 3) {
 
         fprintf(stderr, "Malformed behaviour desciptor at character %d: it "
-                        "must contain two objects: \"type\" and \"duration\"\n",
+                        "must contain two objects: \"type\" and \"duration\", "
+                        "and optionally a \"sector\"\n",
                 tokens->start);
-        exit(-1);
-    }
-
-    // Allocate the new behaviour descriptor
-    behaviour = (TaskBehaviour_t *)malloc(sizeof(TaskBehaviour_t));
-
-    if (behaviour == NULL) {
-
-        perror("Not enough memory for parsing the JSON file");
-        exit(-1);
+        return PARSE_FAILED;
     }
 
-    initTaskBehaviour(behaviour);
-
     currPtr = 1;
 
-    while (foundType == 0 || foundDuration == 0) {
+    while (foundType + foundDuration + foundSector < tokens->size) {
 
         if (tokens[currPtr].type == JSMN_STRING && tokens[currPtr].size == 1 &&
             strncmp("type", descriptors + tokens[currPtr].start,
@@ -209,8 +410,8 @@ unsigned int parseBehaviour(TaskDescriptor_t *desc, char *descriptors,
 
             currPtr = currPtr + 1;
 
-            currPtr = currPtr + parseBehaviourType(behaviour, descriptors,
-                                                   tokens + currPtr);
+            consumed = parseBehaviourType(bursts, index, devices,
+                                          descriptors, tokens + currPtr);
 
         } else if (tokens[currPtr].type == JSMN_STRING &&
                    tokens[currPtr].size == 1 &&
@@ -222,56 +423,73 @@ unsigned int parseBehaviour(TaskDescriptor_t *desc, char *descriptors,
 
             currPtr = currPtr + 1;
 
-            currPtr = currPtr + parseBehaviourDuration(behaviour, descriptors,
-                                                       tokens + currPtr);
+            consumed = parseBehaviourDuration(bursts, index, descriptors,
+                                              tokens + currPtr);
+
+        } else if (foundSector == 0 &&
+                   isField(descriptors, &tokens[currPtr], "sector")) {
+
+            foundSector = 1;
+
+            currPtr = currPtr + 1;
+
+            consumed = parseBehaviourSector(arena, bursts, index,
+                                            descriptors, tokens + currPtr);
 
         } else {
 
             fprintf(stderr, "Unknown behaviour desciptor field at character "
-                            "%d: they must only be: \"type\" or \"duration\"\n",
+                            "%d: they must only be: \"type\", \"duration\" or "
+                            "\"sector\"\n",
                     tokens[currPtr].start);
-            exit(-1);
+            return PARSE_FAILED;
+        }
+
+        if (consumed == PARSE_FAILED) {
+
+            return PARSE_FAILED;
         }
+
+        currPtr = currPtr + consumed;
     }
 
-    appendBehaviour(&(desc->behaviours), behaviour);
+    if (foundType == 0 || foundDuration == 0) {
+
+        fprintf(stderr, "Malformed behaviour desciptor at character %d: it "
+                        "must contain a \"type\" and a \"duration\"\n",
+                tokens->start);
+        return PARSE_FAILED;
+    }
 
     return currPtr;
 }
 
-unsigned int parseDescriptor(TaskDescriptorList_t *list, char *descriptors,
-                             jsmntok_t *tokens) {
+unsigned int parseTask(Arena_t *arena, TaskDescriptor_t *desc,
+                       unsigned int devices, char *descriptors,
+                       jsmntok_t *tokens) {
 
-    TaskDescriptor_t *desc = NULL;
-    unsigned int currPtr = 0, arrayPtr = 0;
+    unsigned int currPtr = 0, arrayPtr = 0, consumed = 0;
     int foundStartTime = 0, foundBehaviour = 0;
-    int foundPriority = 0, foundCommand = 0;
+    int foundPriority = 0, foundCommand = 0, foundQuantum = 0;
+    int foundPartition = 0;
     int i = 0;
 
-    if (tokens->size != 4) {
+    if (tokens->size < 4 || tokens->size > 6) {
 
         fprintf(stderr, "Malformed task desciptor at character %d: it must "
-                        "contain three objects: \"command\", \"start_time\", "
-                        "\"priority\" and \"behaviour\"\n",
+                        "contain four objects: \"command\", \"start_time\", "
+                        "\"priority\" and \"behaviour\", and optionally a "
+                        "\"quantum\" and a \"partition\"\n",
                 tokens->start);
-        exit(-1);
-    }
-
-    // Allocate the new task descriptor
-    desc = (TaskDescriptor_t *)malloc(sizeof(TaskDescriptor_t));
-
-    if (desc == NULL) {
-
-        perror("Not enough memory for parsing the JSON file");
-        exit(-1);
+        return PARSE_FAILED;
     }
 
     initTaskDescriptor(desc);
 
     currPtr = 1;
 
-    while (foundStartTime == 0 || foundBehaviour == 0 || 
-           foundPriority == 0 || foundCommand == 0) {
+    while (foundStartTime + foundBehaviour + foundPriority + foundCommand +
+           foundQuantum + foundPartition < tokens->size) {
 
         if (tokens[currPtr].type == JSMN_STRING && tokens[currPtr].size == 1 &&
             strncmp("behaviour", descriptors + tokens[currPtr].start,
@@ -284,19 +502,51 @@ unsigned int parseDescriptor(TaskDescriptorList_t *list, char *descriptors,
 
             if (tokens[currPtr].type == JSMN_OBJECT) {
 
-                currPtr = currPtr +
-                          parseBehaviour(desc, descriptors, tokens + currPtr);
+                if (allocTaskBursts(&(desc->bursts), arena, 1) != 0) {
+
+                    return PARSE_FAILED;
+                }
+
+                consumed = parseBehaviour(arena, &(desc->bursts), 0, devices,
+                                          descriptors, tokens + currPtr);
 
             } else if (tokens[currPtr].type == JSMN_ARRAY) {
 
                 arrayPtr = currPtr;
 
-                currPtr = currPtr + 1;
+                // A task runs at least one burst
+                if (tokens[arrayPtr].size == 0) {
+
+                    fprintf(stderr, "Empty \"behaviour\" descriptor field at "
+                                    "character %d\n",
+                            tokens[currPtr].start);
+                    return PARSE_FAILED;
+
+                }
+
+                // The array knows the number of bursts, so they can be
+                // allocated at once
+                if (allocTaskBursts(&(desc->bursts), arena,
+                                    tokens[arrayPtr].size) != 0) {
+
+                    return PARSE_FAILED;
+                }
+
+                // The first behaviour follows the token of the array
+                consumed = 1;
 
                 for (i = 0; i < tokens[arrayPtr].size; i++) {
 
-                    currPtr = currPtr + parseBehaviour(desc, descriptors,
-                                                       tokens + currPtr);
+                    currPtr = currPtr + consumed;
+
+                    consumed = parseBehaviour(arena, &(desc->bursts), i,
+                                              devices, descriptors,
+                                              tokens + currPtr);
+
+                    if (consumed == PARSE_FAILED) {
+
+                        return PARSE_FAILED;
+                    }
                 }
 
             } else {
@@ -305,7 +555,7 @@ unsigned int parseDescriptor(TaskDescriptorList_t *list, char *descriptors,
                     stderr,
                     "Invalid \"behaviour\" descriptor field at character %d\n",
                     tokens[currPtr].start);
-                exit(-1);
+                return PARSE_FAILED;
             }
 
         } else if (tokens[currPtr].type == JSMN_STRING &&
@@ -318,8 +568,7 @@ unsigned int parseDescriptor(TaskDescriptorList_t *list, char *descriptors,
 
             currPtr = currPtr + 1;
 
-            currPtr =
-                currPtr + parseStartTime(desc, descriptors, tokens + currPtr);
+            consumed = parseStartTime(desc, descriptors, tokens + currPtr);
 
         } else if (tokens[currPtr].type == JSMN_STRING &&
                    tokens[currPtr].size == 1 &&
@@ -331,9 +580,7 @@ unsigned int parseDescriptor(TaskDescriptorList_t *list, char *descriptors,
 
             currPtr = currPtr + 1;
 
-            currPtr =
-                currPtr + parsePriority(desc, descriptors, tokens + currPtr);
-
+            consumed = parsePriority(desc, descriptors, tokens + currPtr);
 
         } else if (tokens[currPtr].type == JSMN_STRING &&
                    tokens[currPtr].size == 1 &&
@@ -345,170 +592,1323 @@ unsigned int parseDescriptor(TaskDescriptorList_t *list, char *descriptors,
 
             currPtr = currPtr + 1;
 
-            currPtr =
-                currPtr + parseCommand(desc, descriptors, tokens + currPtr);
+            consumed = parseCommand(arena, desc, descriptors,
+                                    tokens + currPtr);
+
+        } else if (foundQuantum == 0 &&
+                   isField(descriptors, &tokens[currPtr], "quantum")) {
+
+            foundQuantum = 1;
+
+            currPtr = currPtr + 1;
+
+            consumed = parseQuantum(desc, descriptors, tokens + currPtr);
+
+        } else if (foundPartition == 0 &&
+                   isField(descriptors, &tokens[currPtr], "partition")) {
+
+            foundPartition = 1;
+
+            currPtr = currPtr + 1;
+
+            consumed = parsePartition(desc, descriptors, tokens + currPtr);
 
         } else {
 
             fprintf(stderr, "Unknown task desciptor field at character %d: "
                             "they must only be: \"command\", \"start_time\", "
-                            "or \"behaviour\"\n",
+                            "\"priority\", \"behaviour\", \"quantum\" or "
+                            "\"partition\"\n",
                     tokens[currPtr].start);
-            exit(-1);
+            return PARSE_FAILED;
         }
+
+        if (consumed == PARSE_FAILED) {
+
+            return PARSE_FAILED;
+        }
+
+        currPtr = currPtr + consumed;
     }
 
-    desc->current = desc->behaviours.first;
+    if (foundStartTime == 0 || foundBehaviour == 0 || foundPriority == 0 ||
+        foundCommand == 0) {
 
-    appendDescriptor(list, desc);
+        fprintf(stderr, "Malformed task desciptor at character %d: it must "
+                        "contain a \"command\", a \"start_time\", a "
+                        "\"priority\" and a \"behaviour\"\n",
+                tokens->start);
+        return PARSE_FAILED;
+    }
+
+    resetTaskDescriptor(desc);
 
     return currPtr;
 }
 
-void parseDescriptors(TaskDescriptorList_t *list, int fd) {
-
-    char *descriptors = NULL;
-    jsmntok_t *tokens = NULL;
+unsigned int parseDescriptor(TaskDescriptorList_t *list, char *descriptors,
+                             jsmntok_t *tokens) {
 
-    off_t size = 0;
-    int count = 0, i = 0;
+    TaskDescriptor_t *desc = NULL;
     unsigned int currPtr = 0;
 
-    jsmn_parser parser;
+    // Allocate the new task descriptor
+    desc = (TaskDescriptor_t *)arenaAlloc(&(list->arena),
+                                          sizeof(TaskDescriptor_t));
 
-    jsmn_init(&parser);
+    if (desc == NULL) {
 
-    // Now we have to find the size of the file
+        return PARSE_FAILED;
+    }
 
-    size = lseek(fd, 0, SEEK_END);
+    currPtr = parseTask(&(list->arena), desc, list->devices.size, descriptors,
+                        tokens);
 
-    if (size < 0) {
+    if (currPtr == PARSE_FAILED) {
 
-        perror("Error accessing descriptors file:");
-        exit(-1);
+        return PARSE_FAILED;
     }
 
-    // Then we have to map the file into memory so that we can parse it
-
-    descriptors = (char *)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    appendDescriptor(list, desc);
 
-    if (descriptors == NULL) {
+    return currPtr;
+}
 
-        perror("Error mapping descriptors file:");
-        exit(-1);
-    }
+/**
+ * @brief Copies a string token to a fixed size buffer.
+ *
+ * @return Zero if the string is empty or does not fit in the buffer.
+ *
+ */
+static int copyString(char *buffer, size_t size, char *descriptors,
+                      jsmntok_t *token) {
 
-    // And then we can parse it. First we need to know how many tokens are
-    // there on the file.
+    size_t length = token->end - token->start;
 
-    count = jsmn_parse(&parser, descriptors, size, NULL, 0);
+    if (token->type != JSMN_STRING || length == 0 || length >= size) {
 
-    if (count < 0) {
+        return 0;
+    }
 
-        fprintf(stderr, "Error when parsing the JSON file");
+    memcpy(buffer, descriptors + token->start, length);
+    buffer[length] = '\0';
 
-        switch (count) {
-        case JSMN_ERROR_INVAL:
-            fprintf(stderr, ": invalid character at position %d\n", parser.pos);
-            break;
-        case JSMN_ERROR_PART:
-            fprintf(stderr, ": premature end of input\n");
-            break;
-        default:
-            break;
-        }
-        exit(-1);
-    }
+    return 1;
+}
 
-    // Now we have to allocate memory to store all the tokens
+/**
+ * @brief Parses the declaration of a device.
+ *
+ * Only the name is mandatory. Devices have a single channel and serve their
+ * requests in FIFO order unless the declaration says otherwise. The
+ * deadline only matters to the deadline discipline. The seek is the number
+ * of ticks a request takes for every sector the head travels, 0 by
+ * default.
+ *
+ * @param config The declaration to be filled.
+ * @param descriptors The string containing the contents of the JSON file.
+ * @param tokens Pointer to the token of the device object.
+ *
+ * @return The number of tokens of the device or PARSE_FAILED if the
+ * declaration is malformed.
+ *
+ */
+static unsigned int parseDevice(DeviceConfig_t *config, char *descriptors,
+                                jsmntok_t *tokens) {
 
-    tokens = (jsmntok_t *)malloc(count * sizeof(jsmntok_t));
+    char discipline[DEVICE_NAME_SIZE];
+    unsigned long channels = 0, deadline = 0, seek = 0;
+    unsigned int currPtr = 1;
+    int foundName = 0, i = 0;
 
-    if (tokens == NULL) {
+    if (tokens[0].type != JSMN_OBJECT) {
 
-        perror("Not enough memory for parsing the JSON file");
-        exit(-1);
+        fprintf(stderr, "Malformed device descriptor at character %d: it "
+                        "must be an object\n", tokens->start);
+        return PARSE_FAILED;
     }
 
-    jsmn_init(&parser);
-
-    count = jsmn_parse(&parser, descriptors, size, tokens, count);
+    config->channels = 1;
+    config->discipline = &fifoDiscipline;
+    config->deadline = DEFAULT_DEADLINE;
+    config->seek = 0;
 
-    // Now we need to check that the JSON contains only one element called
-    // "tasks"
+    for (i = 0; i < tokens[0].size; i++) {
 
-    if (tokens[0].type != JSMN_OBJECT || tokens[0].size != 1 ||
-        (tokens[0].end - tokens[0].start + 1) != size) {
+        if (isField(descriptors, &tokens[currPtr], "name")) {
 
-        fprintf(stderr, "Malformed JSON file: it shall only contain one object "
-                        "called \"tasks\"\n");
-        exit(-1);
-    }
+            if (!copyString(config->name, DEVICE_NAME_SIZE, descriptors,
+                            &tokens[currPtr + 1])) {
 
-    if (tokens[1].type != JSMN_STRING || tokens[1].size != 1 ||
-        strncmp("tasks", descriptors + tokens[1].start,
-                tokens[1].end - tokens[1].start) != 0 ||
-        (tokens[1].end - tokens[1].start) != 5) {
+                fprintf(stderr, "Invalid device name at: %d, it must be a "
+                                "string of 1 to %d characters\n",
+                        tokens[currPtr + 1].start, DEVICE_NAME_SIZE - 1);
+                return PARSE_FAILED;
+            }
 
-        fprintf(stderr, "Malformed JSON file: it shall only contain one "
-                        "element called \"tasks\"\n");
-        exit(-1);
-    }
+            foundName = 1;
 
-    if (tokens[2].type == JSMN_OBJECT) {
+        } else if (isField(descriptors, &tokens[currPtr], "channels")) {
 
-        // Parse a single task, which does not make much sense
-        parseDescriptor(list, descriptors, tokens + 3);
+            if (tokens[currPtr + 1].type == JSMN_PRIMITIVE &&
+                parseDecimal(descriptors, &tokens[currPtr + 1],
+                             &channels) != 0) {
 
-    } else if (tokens[2].type == JSMN_ARRAY) {
+                return PARSE_FAILED;
+            }
 
-        // Parse an array of objects
-        currPtr = 3;
+            if (channels == 0 || channels > MAX_CHANNELS) {
 
-        for (i = 0; i < tokens[2].size; i++) {
+                fprintf(stderr, "Invalid number of channels at: %d, valid "
+                                "values are 1 to %d\n",
+                        tokens[currPtr + 1].start, MAX_CHANNELS);
+                return PARSE_FAILED;
+            }
 
-            currPtr =
-                currPtr + parseDescriptor(list, descriptors, tokens + currPtr);
-        }
+            config->channels = channels;
 
-    } else {
+        } else if (isField(descriptors, &tokens[currPtr], "discipline")) {
 
-        fprintf(stderr, "Malformed JSON file: the description must be an "
-                        "object or an array\n");
-        exit(-1);
-    }
+            if (!copyString(discipline, sizeof(discipline), descriptors,
+                            &tokens[currPtr + 1]) ||
+                (config->discipline = findDiscipline(discipline)) == NULL) {
 
-    free(tokens);
+                fprintf(stderr, "Unknown queueing discipline at: %d\n",
+                        tokens[currPtr + 1].start);
+                return PARSE_FAILED;
+            }
 
-    munmap(descriptors, size);
-}
+        } else if (isField(descriptors, &tokens[currPtr], "deadline")) {
 
-void freeDescriptors(TaskDescriptorList_t *list) {
+            if (tokens[currPtr + 1].type == JSMN_PRIMITIVE &&
+                parseDecimal(descriptors, &tokens[currPtr + 1],
+                             &deadline) != 0) {
 
-    TaskDescriptor_t *currDescriptor = NULL, *freeDescriptor = NULL;
-    TaskBehaviour_t *currBehaviour = NULL, *freeBehaviour = NULL;
+                return PARSE_FAILED;
+            }
 
-    currDescriptor = list->first;
+            if (deadline == 0) {
 
-    while (currDescriptor != NULL) {
+                fprintf(stderr, "Invalid deadline at: %d, it must be a "
+                                "positive number of ticks\n",
+                        tokens[currPtr + 1].start);
+                return PARSE_FAILED;
+            }
 
-        currBehaviour = currDescriptor->behaviours.first;
+            config->deadline = deadline;
 
-        while (currBehaviour != NULL) {
+        } else if (isField(descriptors, &tokens[currPtr], "seek")) {
 
-            freeBehaviour = currBehaviour;
+            if (tokens[currPtr + 1].type != JSMN_PRIMITIVE) {
 
-            currBehaviour = currBehaviour->next;
+                fprintf(stderr, "Invalid seek at: %d, it must be a number of "
+                                "ticks per sector\n",
+                        tokens[currPtr + 1].start);
+                return PARSE_FAILED;
+            }
 
-            free(freeBehaviour);
-        }
+            if (parseDecimal(descriptors, &tokens[currPtr + 1], &seek) != 0) {
 
-        freeDescriptor = currDescriptor;
+                return PARSE_FAILED;
+            }
 
-        currDescriptor = currDescriptor->next;
+            config->seek = seek;
 
-        free(freeDescriptor->pcb.command);
+        } else {
 
-        free(freeDescriptor);
+            fprintf(stderr, "Unknown device descriptor field at character "
+                            "%d: they must only be: \"name\", \"channels\", "
+                            "\"discipline\", \"deadline\" or \"seek\"\n",
+                    tokens[currPtr].start);
+            return PARSE_FAILED;
+        }
+
+        // Every value is a single token
+        currPtr = currPtr + 2;
+    }
+
+    if (!foundName) {
+
+        fprintf(stderr, "Malformed device descriptor at character %d: it "
+                        "must contain a \"name\"\n", tokens->start);
+        return PARSE_FAILED;
+    }
+
+    return currPtr;
+}
+
+/**
+ * @brief Parses the array of devices of a descriptor file.
+ *
+ * The devices replace the default ones, and the bursts of type n > 0 are
+ * served by the device n - 1 of the array.
+ *
+ * @param devices The device table to be filled.
+ * @param descriptors The string containing the contents of the JSON file.
+ * @param tokens Pointer to the token of the array.
+ *
+ * @return The number of tokens of the array or PARSE_FAILED if it is
+ * malformed.
+ *
+ */
+static unsigned int parseDevices(DeviceTable_t *devices, char *descriptors,
+                                 jsmntok_t *tokens) {
+
+    unsigned int currPtr = 1, consumed = 0;
+    int i = 0, j = 0;
+
+    if (tokens[0].type != JSMN_ARRAY || tokens[0].size > MAX_DEVICES) {
+
+        fprintf(stderr, "Invalid \"devices\" field at character %d: it "
+                        "must be an array of up to %d devices\n",
+                tokens->start, MAX_DEVICES);
+        return PARSE_FAILED;
+    }
+
+    for (i = 0; i < tokens[0].size; i++) {
+
+        consumed = parseDevice(&(devices->devices[i]), descriptors,
+                               tokens + currPtr);
+
+        if (consumed == PARSE_FAILED) {
+
+            return PARSE_FAILED;
+        }
+
+        currPtr = currPtr + consumed;
+
+        for (j = 0; j < i; j++) {
+
+            if (strcmp(devices->devices[i].name,
+                       devices->devices[j].name) == 0) {
+
+                fprintf(stderr, "Duplicated device name \"%s\"\n",
+                        devices->devices[i].name);
+                return PARSE_FAILED;
+            }
+        }
+    }
+
+    devices->size = tokens[0].size;
+    devices->implicit = 0;
+
+    return currPtr;
+}
+
+/**
+ * @brief Tokenises a chunk of a JSON file.
+ *
+ * The token buffer grows whenever jsmn runs out of tokens. jsmn keeps its
+ * state, so the parse resumes where it stopped instead of starting over.
+ *
+ * @param parser The jsmn parser, positioned at the beginning of the chunk.
+ * @param descriptors The string containing the contents of the JSON file.
+ * @param end Position right after the end of the chunk.
+ * @param tokens Pointer to the token buffer, which may be reallocated.
+ * @param capacity Pointer to the number of tokens of the buffer.
+ *
+ * @return The number of tokens of the chunk or -1 on error.
+ *
+ */
+static int tokenize(jsmn_parser *parser, char *descriptors, size_t end,
+                    jsmntok_t **tokens, unsigned int *capacity) {
+
+    jsmntok_t *grown = NULL;
+    int count = 0;
+
+    do {
+
+        if (count == JSMN_ERROR_NOMEM || *tokens == NULL) {
+
+            if (*tokens != NULL) {
+
+                *capacity = *capacity * 2;
+            }
+
+            // The caller keeps the old buffer if it cannot grow
+            grown = (jsmntok_t *)realloc(*tokens,
+                                         *capacity * sizeof(jsmntok_t));
+
+            if (grown == NULL) {
+
+                perror("Not enough memory for parsing the JSON file");
+                return -1;
+            }
+
+            *tokens = grown;
+        }
+
+        count = jsmn_parse(parser, descriptors, end, *tokens, *capacity);
+
+    } while (count == JSMN_ERROR_NOMEM);
+
+    if (count < 0) {
+
+        fprintf(stderr, "Error when parsing the JSON file");
+
+        switch (count) {
+        case JSMN_ERROR_INVAL:
+            fprintf(stderr, ": invalid character at position %d\n",
+                    parser->pos);
+            break;
+        case JSMN_ERROR_PART:
+            fprintf(stderr, ": premature end of input\n");
+            break;
+        default:
+            break;
+        }
+        return -1;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Maps a descriptor file into memory.
+ *
+ * @param fd File descriptor of the opened JSON file.
+ * @param size Pointer where the size of the file is stored.
+ *
+ * @return The contents of the file or NULL on error.
+ *
+ */
+static char *mapDescriptors(int fd, size_t *size) {
+
+    char *descriptors = NULL;
+    off_t length = 0;
+
+    // First we have to find the size of the file
+
+    length = lseek(fd, 0, SEEK_END);
+
+    if (length < 0) {
+
+        perror("Error accessing descriptors file:");
+        return NULL;
+    }
+
+    // Then we have to map the file into memory so that we can parse it
+
+    descriptors = (char *)mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if (descriptors == MAP_FAILED) {
+
+        perror("Error mapping descriptors file:");
+        return NULL;
+    }
+
+    *size = length;
+
+    return descriptors;
+}
+
+/**
+ * @brief Skips the white space of a JSON file.
+ *
+ * @return The position of the first non white space character.
+ *
+ */
+static size_t skipSpaces(char *descriptors, size_t size, size_t pos) {
+
+    while (pos < size && (descriptors[pos] == ' ' || descriptors[pos] == '\t' ||
+                          descriptors[pos] == '\n' || descriptors[pos] == '\r')) {
+
+        pos = pos + 1;
+    }
+
+    return pos;
+}
+
+/**
+ * @brief Checks that a character is at a given position of a JSON file.
+ *
+ * @return The position right after the character or PARSE_FAILED if it is
+ * not there.
+ *
+ */
+static size_t expectChar(char *descriptors, size_t size, size_t pos, char c) {
+
+    pos = skipSpaces(descriptors, size, pos);
+
+    if (pos >= size || descriptors[pos] != c) {
+
+        fprintf(stderr, "Malformed JSON file: expected '%c' at character "
+                        "%zu\n", c, pos);
+        return PARSE_FAILED;
+    }
+
+    return pos + 1;
+}
+
+/**
+ * @brief Finds the end of the JSON object that begins at a given position.
+ *
+ * @return The position of the closing brace of the object or PARSE_FAILED
+ * if the file ends before it.
+ *
+ */
+static size_t findObjectEnd(char *descriptors, size_t size, size_t pos) {
+
+    unsigned int depth = 0;
+    int inString = 0;
+
+    for (; pos < size; pos++) {
+
+        if (inString) {
+
+            if (descriptors[pos] == '\\') {
+
+                pos = pos + 1;
+
+            } else if (descriptors[pos] == '"') {
+
+                inString = 0;
+            }
+
+        } else if (descriptors[pos] == '"') {
+
+            inString = 1;
+
+        } else if (descriptors[pos] == '{' || descriptors[pos] == '[') {
+
+            depth = depth + 1;
+
+        } else if (descriptors[pos] == '}' || descriptors[pos] == ']') {
+
+            depth = depth - 1;
+
+            if (depth == 0) {
+
+                return pos;
+            }
+        }
+    }
+
+    fprintf(stderr, "Error when parsing the JSON file: premature end of "
+                    "input\n");
+    return PARSE_FAILED;
+}
+
+/**
+ * @brief Tokenises and parses the array of devices of a descriptor file.
+ *
+ * @param devices The device table to be filled.
+ * @param descriptors The string containing the contents of the JSON file.
+ * @param size The size of the file.
+ * @param pos Position of the array.
+ *
+ * @return The position right after the closing bracket of the array or
+ * PARSE_FAILED if the array is malformed.
+ *
+ */
+static size_t parseDevicesAt(DeviceTable_t *devices, char *descriptors,
+                             size_t size, size_t pos) {
+
+    jsmn_parser parser;
+    jsmntok_t *tokens = NULL;
+    unsigned int capacity = 64;
+    size_t end = 0;
+    unsigned int consumed = PARSE_FAILED;
+
+    pos = skipSpaces(descriptors, size, pos);
+
+    if (pos >= size || descriptors[pos] != '[') {
+
+        fprintf(stderr, "Malformed JSON file: \"devices\" must be an "
+                        "array\n");
+        return PARSE_FAILED;
+    }
+
+    end = findObjectEnd(descriptors, size, pos);
+
+    if (end == PARSE_FAILED) {
+
+        return PARSE_FAILED;
+    }
+
+    jsmn_init(&parser);
+    parser.pos = pos;
+
+    if (tokenize(&parser, descriptors, end + 1, &tokens, &capacity) >= 0) {
+
+        consumed = parseDevices(devices, descriptors, tokens);
+    }
+
+    free(tokens);
+
+    return consumed != PARSE_FAILED ? end + 1 : PARSE_FAILED;
+}
+
+/**
+ * @brief Checks the header of a descriptor file without tokenising it.
+ *
+ * @param descriptors The string containing the contents of the JSON file.
+ * @param size The size of the file.
+ * @param devices The device table, filled if the file declares its devices.
+ * @param single Pointer where a non-zero value is stored if "tasks" is a
+ *               single object instead of an array.
+ *
+ * @return The position of the first task if "tasks" is a single object,
+ *         the position right after the opening bracket of the array or
+ *         PARSE_FAILED if the header is malformed.
+ *
+ */
+static size_t findTasks(char *descriptors, size_t size, DeviceTable_t *devices,
+                        int *single) {
+
+    size_t pos = 0;
+
+    // The header must be: { "tasks" : followed by an array or an object,
+    // optionally preceded by "devices" : followed by an array
+
+    pos = expectChar(descriptors, size, pos, '{');
+
+    if (pos == PARSE_FAILED) {
+
+        return PARSE_FAILED;
+    }
+
+    pos = skipSpaces(descriptors, size, pos);
+
+    if (size - pos >= 9 && strncmp("\"devices\"", descriptors + pos, 9) == 0) {
+
+        pos = expectChar(descriptors, size, pos + 9, ':');
+
+        if (pos != PARSE_FAILED) {
+
+            pos = parseDevicesAt(devices, descriptors, size, pos);
+        }
+
+        if (pos != PARSE_FAILED) {
+
+            pos = expectChar(descriptors, size, pos, ',');
+        }
+
+        if (pos == PARSE_FAILED) {
+
+            return PARSE_FAILED;
+        }
+
+        pos = skipSpaces(descriptors, size, pos);
+    }
+
+    if (size - pos < 7 || strncmp("\"tasks\"", descriptors + pos, 7) != 0) {
+
+        fprintf(stderr, "Malformed JSON file: it shall only contain one "
+                        "element called \"tasks\"\n");
+        return PARSE_FAILED;
+    }
+
+    pos = expectChar(descriptors, size, pos + 7, ':');
+
+    if (pos == PARSE_FAILED) {
+
+        return PARSE_FAILED;
+    }
+
+    pos = skipSpaces(descriptors, size, pos);
+
+    if (pos < size && descriptors[pos] == '[') {
+
+        *single = 0;
+
+        return pos + 1;
+
+    } else if (pos < size && descriptors[pos] == '{') {
+
+        *single = 1;
+
+        return pos;
+    }
+
+    fprintf(stderr, "Malformed JSON file: the description must be an "
+                    "object or an array\n");
+    return PARSE_FAILED;
+}
+
+/**
+ * @brief Checks that only the end of the file follows the tasks.
+ *
+ * @param descriptors The string containing the contents of the JSON file.
+ * @param size The size of the file.
+ * @param pos Position right after the last task or the closing bracket of
+ *            the array of tasks.
+ *
+ * @return 0 if the file ends right after the tasks, -1 otherwise.
+ *
+ */
+static int checkTrailer(char *descriptors, size_t size, size_t pos) {
+
+    pos = expectChar(descriptors, size, pos, '}');
+
+    if (pos == PARSE_FAILED) {
+
+        return -1;
+    }
+
+    if (skipSpaces(descriptors, size, pos) != size) {
+
+        fprintf(stderr, "Malformed JSON file: it shall only contain one object "
+                        "called \"tasks\"\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Tokenises and parses a single task object of a descriptor file.
+ *
+ * The tokens keep their offsets in the file, so the error messages point to
+ * the right character.
+ *
+ * @param arena The arena where the bursts and the command are stored.
+ * @param desc The descriptor to be filled.
+ * @param devices The number of devices of the file.
+ * @param descriptors The string containing the contents of the JSON file.
+ * @param start Position of the opening brace of the task.
+ * @param end Position of the closing brace of the task.
+ * @param tokens Pointer to the token buffer, which may be reallocated.
+ * @param capacity Pointer to the number of tokens of the buffer.
+ *
+ * @return 0 on success, -1 if the task is malformed.
+ *
+ */
+static int parseTaskAt(Arena_t *arena, TaskDescriptor_t *desc,
+                       unsigned int devices, char *descriptors, size_t start,
+                       size_t end, jsmntok_t **tokens,
+                       unsigned int *capacity) {
+
+    jsmn_parser parser;
+
+    jsmn_init(&parser);
+    parser.pos = start;
+
+    if (tokenize(&parser, descriptors, end + 1, tokens, capacity) < 0 ||
+        parseTask(arena, desc, devices, descriptors, *tokens) ==
+            PARSE_FAILED) {
+
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Parses the tokens of a whole descriptor file.
+ *
+ * @param list Pointer to the list that will store the parsed descriptors.
+ * @param descriptors The string containing the contents of the JSON file.
+ * @param size The size of the file.
+ * @param tokens The tokens of the file.
+ * @param count The number of tokens.
+ *
+ * @return 0 on success, -1 if the file is malformed.
+ *
+ */
+static int parseTokens(TaskDescriptorList_t *list, char *descriptors,
+                       size_t size, jsmntok_t *tokens, int count) {
+
+    int i = 0;
+    unsigned int currPtr = 0, tasksPtr = 0, consumed = 0;
+
+    // Now we need to check that the JSON contains only one element called
+    // "tasks", optionally preceded by the "devices"
+
+    if (count < 3 || tokens[0].type != JSMN_OBJECT ||
+        (tokens[0].size != 1 && tokens[0].size != 2) ||
+        (tokens[0].end - tokens[0].start + 1) != size) {
+
+        fprintf(stderr, "Malformed JSON file: it shall only contain one object "
+                        "called \"tasks\"\n");
+        return -1;
+    }
+
+    currPtr = 1;
+
+    if (tokens[0].size == 2) {
+
+        if (!isField(descriptors, &tokens[1], "devices")) {
+
+            fprintf(stderr, "Malformed JSON file: only \"devices\" may "
+                            "precede \"tasks\"\n");
+            return -1;
+        }
+
+        consumed = parseDevices(&(list->devices), descriptors, tokens + 2);
+
+        if (consumed == PARSE_FAILED) {
+
+            return -1;
+        }
+
+        currPtr = 2 + consumed;
+    }
+
+    if (currPtr + 1 >= (unsigned int)count ||
+        !isField(descriptors, &tokens[currPtr], "tasks")) {
+
+        fprintf(stderr, "Malformed JSON file: it shall only contain one "
+                        "element called \"tasks\"\n");
+        return -1;
+    }
+
+    tasksPtr = currPtr + 1;
+
+    if (tokens[tasksPtr].type == JSMN_OBJECT) {
+
+        // Parse a single task, which does not make much sense
+        if (parseDescriptor(list, descriptors, tokens + tasksPtr) ==
+            PARSE_FAILED) {
+
+            return -1;
+        }
+
+    } else if (tokens[tasksPtr].type == JSMN_ARRAY) {
+
+        // Parse an array of objects
+        currPtr = tasksPtr + 1;
+
+        for (i = 0; i < tokens[tasksPtr].size; i++) {
+
+            consumed = parseDescriptor(list, descriptors, tokens + currPtr);
+
+            if (consumed == PARSE_FAILED) {
+
+                return -1;
+            }
+
+            currPtr = currPtr + consumed;
+        }
+
+    } else {
+
+        fprintf(stderr, "Malformed JSON file: the description must be an "
+                        "object or an array\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+int parseDescriptors(TaskDescriptorList_t *list, int fd) {
+
+    char *descriptors = NULL;
+    jsmntok_t *tokens = NULL;
+
+    size_t size = 0;
+    int count = 0, result = -1;
+    unsigned int capacity = 0;
+
+    jsmn_parser parser;
+
+    jsmn_init(&parser);
+
+    descriptors = mapDescriptors(fd, &size);
+
+    if (descriptors == NULL) {
+
+        return -1;
+    }
+
+    // And then we can parse it in a single pass. The token buffer starts
+    // with a rough estimate of the number of tokens.
+
+    capacity = size / TOKEN_BYTES_ESTIMATE + 64;
+
+    count = tokenize(&parser, descriptors, size, &tokens, &capacity);
+
+    if (count >= 0) {
+
+        result = parseTokens(list, descriptors, size, tokens, count);
+    }
+
+    free(tokens);
+
+    munmap(descriptors, size);
+
+    return result;
+}
+
+/**
+ * A run of consecutive tasks of a descriptor file, parsed by a thread into
+ * its own list.
+ */
+typedef struct {
+
+    char *descriptors;
+
+    /** Position of the first task */
+    size_t start;
+
+    /** Position right after the last task */
+    size_t end;
+
+    /** Number of devices of the file */
+    unsigned int devices;
+
+    TaskDescriptorList_t list;
+
+    /** 0 once the chunk is parsed, -1 if any of its tasks is malformed */
+    int result;
+
+} ParseChunk_t;
+
+static void *parseChunk(void *arg) {
+
+    ParseChunk_t *chunk = (ParseChunk_t *)arg;
+    TaskDescriptor_t *desc = NULL;
+    jsmntok_t *tokens = NULL;
+    jsmn_parser parser;
+    int count = 0, currPtr = 0;
+    unsigned int capacity = 0, consumed = 0;
+
+    // The boundaries have already been checked, so the chunk is only made
+    // of task objects separated by commas, which jsmn tokenises one after
+    // the other
+
+    jsmn_init(&parser);
+    parser.pos = chunk->start;
+
+    capacity = (chunk->end - chunk->start) / TOKEN_BYTES_ESTIMATE + 64;
+
+    count = tokenize(&parser, chunk->descriptors, chunk->end, &tokens,
+                     &capacity);
+
+    chunk->result = count < 0 ? -1 : 0;
+
+    while (currPtr < count) {
+
+        desc = (TaskDescriptor_t *)arenaAlloc(&(chunk->list.arena),
+                                              sizeof(TaskDescriptor_t));
+
+        if (desc == NULL) {
+
+            chunk->result = -1;
+            break;
+        }
+
+        consumed = parseTask(&(chunk->list.arena), desc, chunk->devices,
+                             chunk->descriptors, tokens + currPtr);
+
+        if (consumed == PARSE_FAILED) {
+
+            chunk->result = -1;
+            break;
+        }
+
+        currPtr = currPtr + consumed;
+
+        appendDescriptor(&(chunk->list), desc);
+    }
+
+    free(tokens);
+
+    return NULL;
+}
+
+/**
+ * @brief Splits the array of tasks of a descriptor file in chunks.
+ *
+ * The boundaries of the tasks are found with a quick scan that only follows
+ * braces and strings, and the array is cut in chunks of similar size.
+ *
+ * @param chunks The chunks to be filled, at least threads of them.
+ * @param threads Maximum number of chunks.
+ * @param descriptors The string containing the contents of the JSON file.
+ * @param size The size of the file.
+ * @param pos Position right after the opening bracket of the array.
+ *
+ * @return The number of chunks or 0 if the file is malformed.
+ *
+ */
+static unsigned int splitChunks(ParseChunk_t *chunks, unsigned int threads,
+                                char *descriptors, size_t size, size_t pos) {
+
+    size_t end = 0, target = 0;
+    unsigned int count = 0;
+
+    target = (size - pos) / threads;
+
+    pos = skipSpaces(descriptors, size, pos);
+
+    chunks[0].start = chunks[0].end = pos;
+    count = 1;
+
+    while (pos >= size || descriptors[pos] != ']') {
+
+        if (pos >= size || descriptors[pos] != '{') {
+
+            fprintf(stderr, "Malformed JSON file: expected a task descriptor "
+                            "at character %zu\n", pos);
+            return 0;
+        }
+
+        end = findObjectEnd(descriptors, size, pos);
+
+        if (end == PARSE_FAILED) {
+
+            return 0;
+        }
+
+        end = end + 1;
+
+        chunks[count - 1].end = end;
+
+        pos = skipSpaces(descriptors, size, end);
+
+        if (pos < size && descriptors[pos] == ',') {
+
+            pos = skipSpaces(descriptors, size, pos + 1);
+
+            if (end - chunks[count - 1].start >= target && count < threads) {
+
+                chunks[count].start = chunks[count].end = pos;
+                count = count + 1;
+            }
+
+        } else if (pos >= size || descriptors[pos] != ']') {
+
+            fprintf(stderr, "Malformed JSON file: expected ',' or ']' at "
+                            "character %zu\n", pos);
+            return 0;
+        }
+    }
+
+    if (checkTrailer(descriptors, size, pos + 1) != 0) {
+
+        return 0;
+    }
+
+    return count;
+}
+
+int parseDescriptorsParallel(TaskDescriptorList_t *list, int fd,
+                             unsigned int threads) {
+
+    char *descriptors = NULL;
+    ParseChunk_t *chunks = NULL;
+    pthread_t *pool = NULL;
+
+    size_t size = 0, pos = 0;
+    unsigned int count = 0, i = 0;
+    int single = 0, result = 0;
+
+    descriptors = mapDescriptors(fd, &size);
+
+    if (descriptors == NULL) {
+
+        return -1;
+    }
+
+    pos = findTasks(descriptors, size, &(list->devices), &single);
+
+    if (pos == PARSE_FAILED) {
+
+        munmap(descriptors, size);
+
+        return -1;
+    }
+
+    if (size / PARSE_CHUNK_MIN < threads) {
+
+        threads = size / PARSE_CHUNK_MIN;
+    }
+
+    if (single || threads <= 1) {
+
+        // Not worth splitting
+        munmap(descriptors, size);
+
+        return parseDescriptors(list, fd);
+    }
+
+    chunks = (ParseChunk_t *)malloc(threads * sizeof(ParseChunk_t));
+    pool = (pthread_t *)malloc(threads * sizeof(pthread_t));
+
+    if (chunks == NULL || pool == NULL) {
+
+        perror("Not enough memory for parsing the JSON file");
+        result = -1;
+
+    } else {
+
+        count = splitChunks(chunks, threads, descriptors, size, pos);
+        result = count != 0 ? 0 : -1;
+    }
+
+    // Parse every chunk on its own thread, into its own list and arena
+
+    for (i = 0; i < count; i++) {
+
+        chunks[i].descriptors = descriptors;
+        chunks[i].devices = list->devices.size;
+
+        initTaskDescriptorList(&(chunks[i].list));
+
+        if (pthread_create(&pool[i], NULL, parseChunk, &chunks[i]) != 0) {
+
+            perror("Error creating the parser threads");
+            result = -1;
+
+            // Only wait for the threads already created
+            count = i;
+        }
+    }
+
+    // And append the chunks to the list in the order of the file
+
+    for (i = 0; i < count; i++) {
+
+        pthread_join(pool[i], NULL);
+
+        concatDescriptors(list, &(chunks[i].list));
+
+        if (chunks[i].result != 0) {
+
+            result = -1;
+        }
+    }
+
+    free(pool);
+    free(chunks);
+
+    munmap(descriptors, size);
+
+    return result;
+}
+
+void freeDescriptors(TaskDescriptorList_t *list) {
+
+    // The descriptors, their bursts and their commands live in the arena
+    freeArena(&(list->arena));
+
+    // Unless the list was loaded from a binary workload
+    if (list->mapping != NULL) {
+
+        munmap(list->mapping, list->mappingSize);
+    }
+
+    list->mapping = NULL;
+    list->mappingSize = 0;
+
+    list->size = 0;
+    list->first = NULL;
+    list->last = NULL;
+}
+
+/**
+ * Initial size of the arena of a streamed task. A typical task fits in it,
+ * so every task needs a single allocation besides its descriptor.
+ */
+#define STREAM_TASK_ARENA 256
+
+/** Bytes consumed between two attempts to return pages to the kernel */
+#define STREAM_RELEASE_BYTES (1 << 20)
+
+/**
+ * A task parsed by a streaming source, along with the arena that stores its
+ * bursts and command. The descriptor must be the first field, so that
+ * the source can recover the task from the descriptor it handed out.
+ */
+typedef struct {
+
+    TaskDescriptor_t desc;
+    Arena_t arena;
+
+} StreamedTask_t;
+
+/**
+ * @brief Checks the end of a descriptor file once all the tasks are parsed.
+ */
+static void finishStream(StreamSource_t *stream) {
+
+    if (checkTrailer(stream->descriptors, stream->size, stream->pos) != 0) {
+
+        stream->failed = 1;
+    }
+
+    stream->pos = stream->size;
+    stream->done = 1;
+}
+
+/**
+ * @brief Ends a stream whose next task is malformed.
+ *
+ * @return NULL, as if there were no more tasks.
+ */
+static TaskDescriptor_t *failStream(StreamSource_t *stream) {
+
+    stream->failed = 1;
+    stream->done = 1;
+
+    return NULL;
+}
+
+/**
+ * @brief Returns the pages of the file that have already been parsed to the
+ *        kernel, so that the resident memory does not grow with the file.
+ */
+static void releaseParsedPages(StreamSource_t *stream) {
+
+    size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    size_t end = stream->pos / pageSize * pageSize;
+
+    if (end - stream->released < STREAM_RELEASE_BYTES) {
+
+        return;
+    }
+
+    madvise(stream->descriptors + stream->released, end - stream->released,
+            MADV_DONTNEED);
+
+    stream->released = end;
+}
+
+static void releaseToStream(TaskSource_t *source, TaskDescriptor_t *desc) {
+
+    StreamedTask_t *task = (StreamedTask_t *)desc;
+
+    freeArena(&(task->arena));
+    free(task);
+}
+
+static TaskDescriptor_t *nextFromStream(TaskSource_t *source) {
+
+    StreamSource_t *stream = (StreamSource_t *)source;
+    StreamedTask_t *task = NULL;
+    size_t start = 0, end = 0;
+
+    if (stream->done) {
+
+        return NULL;
+    }
+
+    start = skipSpaces(stream->descriptors, stream->size, stream->pos);
+
+    if (stream->single) {
+
+        if (stream->tasks == 1) {
+
+            finishStream(stream);
+            return NULL;
+        }
+
+    } else {
+
+        if (start < stream->size && stream->descriptors[start] == ']') {
+
+            stream->pos = start + 1;
+            finishStream(stream);
+            return NULL;
+        }
+
+        if (stream->tasks != 0) {
+
+            start = expectChar(stream->descriptors, stream->size, start, ',');
+
+            if (start == PARSE_FAILED) {
+
+                return failStream(stream);
+            }
+
+            start = skipSpaces(stream->descriptors, stream->size, start);
+        }
+    }
+
+    if (start >= stream->size || stream->descriptors[start] != '{') {
+
+        fprintf(stderr, "Malformed JSON file: expected a task descriptor at "
+                        "character %zu\n", start);
+        return failStream(stream);
+    }
+
+    end = findObjectEnd(stream->descriptors, stream->size, start);
+
+    if (end == PARSE_FAILED) {
+
+        return failStream(stream);
+    }
+
+    task = (StreamedTask_t *)malloc(sizeof(StreamedTask_t));
+
+    if (task == NULL) {
+
+        perror("Not enough memory for the task descriptor");
+        return failStream(stream);
     }
+
+    initArenaWithBlockSize(&(task->arena), STREAM_TASK_ARENA);
+
+    if (parseTaskAt(&(task->arena), &(task->desc), stream->devices.size,
+                    stream->descriptors, start, end, &(stream->tokens),
+                    &(stream->capacity)) != 0) {
+
+        releaseToStream(source, &(task->desc));
+        return failStream(stream);
+    }
+
+    if (task->desc.startTime < stream->lastStartTime) {
+
+        fprintf(stderr, "Task descriptor at character %zu starts before the "
+                        "previous one: the tasks must be sorted by start time "
+                        "to be streamed\n", start);
+        releaseToStream(source, &(task->desc));
+        return failStream(stream);
+    }
+
+    stream->lastStartTime = task->desc.startTime;
+    stream->tasks = stream->tasks + 1;
+    stream->pos = end + 1;
+
+    releaseParsedPages(stream);
+
+    return &(task->desc);
+}
+
+int openStreamSource(StreamSource_t *stream, int fd) {
+
+    memset(stream, 0, sizeof(StreamSource_t));
+
+    stream->source.next = nextFromStream;
+    stream->source.release = releaseToStream;
+    stream->source.devices = &(stream->devices);
+
+    stream->descriptors = mapDescriptors(fd, &(stream->size));
+
+    if (stream->descriptors == NULL) {
+
+        return -1;
+    }
+
+    // The tasks are parsed in order, so the file is read sequentially
+    madvise(stream->descriptors, stream->size, MADV_SEQUENTIAL);
+
+    initDeviceTable(&(stream->devices));
+
+    stream->pos = findTasks(stream->descriptors, stream->size,
+                            &(stream->devices), &(stream->single));
+
+    if (stream->pos == PARSE_FAILED) {
+
+        munmap(stream->descriptors, stream->size);
+        stream->descriptors = NULL;
+
+        return -1;
+    }
+
+    // Tasks are small, so a few tokens are usually enough
+    stream->capacity = 64;
+
+    return 0;
+}
+
+void closeStreamSource(StreamSource_t *stream) {
+
+    free(stream->tokens);
+
+    munmap(stream->descriptors, stream->size);
+
+    stream->tokens = NULL;
+    stream->descriptors = NULL;
 }
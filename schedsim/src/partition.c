@@ -0,0 +1,1017 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <pthread.h>
+
+#include <partition.h>
+#include <metrics.h>
+
+/**
+ * Request of a device issued by a partition while it was running on its own.
+ */
+typedef struct {
+
+    unsigned int tick;
+    /** CPU that issued the request, counted over the whole system */
+    unsigned int cpu;
+    unsigned int device;
+    PCB_t * pcb;
+
+} DeviceRequest_t;
+
+struct parallel_run;
+
+/**
+ * Source of the tasks of a partition. The main thread hands the arriving
+ * tasks to the partitions before every window, so the partitions never pull
+ * from the source of the simulation while they run.
+ */
+typedef struct {
+
+    TaskSource_t source;
+
+    /** Tasks handed to the partition that have not been pulled yet */
+    TaskDescriptor_t ** tasks;
+    unsigned int first;
+    unsigned int size;
+    unsigned int capacity;
+
+    /** Run the partition belongs to */
+    struct parallel_run * run;
+
+    /** Tick in which the last task of the partition finished */
+    unsigned int lastExit;
+
+} PartitionSource_t;
+
+/**
+ * Partition of the CPUs, simulated by its own simulator.
+ */
+typedef struct {
+
+    /** Simulator of the partition. It must be the first member */
+    Simulator_t sim;
+
+    PartitionSource_t source;
+
+    /** First CPU of the partition, counted over the whole system */
+    unsigned int firstCpu;
+
+    /**
+     * Devices seen by the partition while it runs on its own. They have no
+     * channels, so every request is queued, and then moved to the requests
+     * of the partition
+     */
+    Device_t staging[MAX_DEVICES];
+
+    /** Requests not applied to the devices yet, in tick order */
+    DeviceRequest_t * requests;
+    unsigned int requestCount;
+    unsigned int requestCapacity;
+
+    /** First tick in which a device may interrupt the partition */
+    unsigned int bound;
+
+    /** Non-zero if only the CPUs of the current tick have been simulated */
+    int midTick;
+
+} Partition_t;
+
+/**
+ * State of a simulation run by the parallel engine.
+ */
+typedef struct parallel_run {
+
+    Simulator_t * sim;
+
+    Partition_t * partitions;
+    unsigned int count;
+    unsigned int threads;
+
+    /** Last tick simulated on the devices */
+    unsigned int deviceClock;
+
+    /** Tick up to which the partitions may run in the current window */
+    unsigned int target;
+
+    /** Non-zero once the simulation is over */
+    int done;
+
+    /** Requests of all the partitions applied in the current window */
+    DeviceRequest_t * requests;
+    unsigned int requestCapacity;
+
+    /** Protects the source of the simulation when the tasks are released */
+    pthread_mutex_t lock;
+
+    pthread_barrier_t start;
+    pthread_barrier_t end;
+
+} ParallelRun_t;
+
+/**
+ * Devices of the source of a partition. The partitions do not own any
+ * device: they share the devices of the whole system
+ */
+static const DeviceTable_t sharedDevices = { 0 };
+
+typedef struct {
+
+    ParallelRun_t * run;
+    unsigned int index;
+    pthread_t thread;
+
+} PartitionWorker_t;
+
+/**
+ * @brief Adds a number of ticks to a clock, saturating at UINT_MAX.
+ */
+static unsigned int addTicks(unsigned int clock, unsigned int ticks) {
+
+    return ticks > UINT_MAX - clock ? UINT_MAX : clock + ticks;
+
+}
+
+/**
+ * @brief Makes room for one more request in an array of requests.
+ *
+ * @return 0 on success, -1 if there is not enough memory. The array is
+ * then left as it was.
+ */
+static int growRequests(DeviceRequest_t ** requests, unsigned int * capacity) {
+
+    unsigned int grown = *capacity == 0 ? 64 : *capacity * 2;
+    DeviceRequest_t * array = NULL;
+
+    array = (DeviceRequest_t *)realloc(*requests,
+                                       grown * sizeof(DeviceRequest_t));
+
+    if (array == NULL) {
+
+        perror("Not enough memory for the device requests");
+        return -1;
+
+    }
+
+    *requests = array;
+    *capacity = grown;
+
+    return 0;
+
+}
+
+static TaskDescriptor_t * nextFromPartition(TaskSource_t * source) {
+
+    PartitionSource_t * partitionSource = (PartitionSource_t *)source;
+
+    if (partitionSource->first == partitionSource->size) {
+
+        return NULL;
+
+    }
+
+    partitionSource->first = partitionSource->first + 1;
+
+    return partitionSource->tasks[partitionSource->first - 1];
+
+}
+
+static void releaseToPartition(TaskSource_t * source, TaskDescriptor_t * desc) {
+
+    PartitionSource_t * partitionSource = (PartitionSource_t *)source;
+    Simulator_t * sim = partitionSource->run->sim;
+    TaskSource_t * shared = sim->source;
+    unsigned int i = 0;
+
+    if (desc->sim->clock > partitionSource->lastExit) {
+
+        partitionSource->lastExit = desc->sim->clock;
+
+    }
+
+    // Several partitions may finish tasks at the same time
+    pthread_mutex_lock(&(partitionSource->run->lock));
+
+    // The partition forgets the task on its staging devices only, and the
+    // devices are not simulated while the partitions run
+    for (i = 0; i < sim->deviceCount; i++) {
+
+        forgetDeviceService(&(sim->devices[i]), (PCB_t *)desc);
+
+    }
+
+    shared->release(shared, desc);
+
+    pthread_mutex_unlock(&(partitionSource->run->lock));
+
+}
+
+/**
+ * @brief Hands an arriving task to a partition.
+ *
+ * @return 0 on success, -1 if there is not enough memory.
+ */
+static int feedPartition(Partition_t * partition, TaskDescriptor_t * desc) {
+
+    PartitionSource_t * source = &(partition->source);
+    TaskDescriptor_t ** tasks = NULL;
+    unsigned int capacity = 0;
+
+    // Reuse the array once all the tasks have been pulled
+    if (source->first == source->size) {
+
+        source->first = 0;
+        source->size = 0;
+
+    }
+
+    if (source->size == source->capacity) {
+
+        capacity = source->capacity == 0 ? 64 : source->capacity * 2;
+
+        tasks = (TaskDescriptor_t **)realloc(source->tasks,
+                    capacity * sizeof(TaskDescriptor_t *));
+
+        if (tasks == NULL) {
+
+            perror("Not enough memory for the tasks of a partition");
+            return -1;
+
+        }
+
+        source->tasks = tasks;
+        source->capacity = capacity;
+
+    }
+
+    source->tasks[source->size] = desc;
+    source->size = source->size + 1;
+
+    return 0;
+
+}
+
+/**
+ * @brief Lowers the bound of the partition a task belongs to.
+ */
+static void boundPartition(PCB_t * pcb, unsigned int bound) {
+
+    // The simulator is the first member of the partition
+    Partition_t * partition = (Partition_t *)((TaskDescriptor_t *)pcb)->sim;
+
+    if (bound < partition->bound) {
+
+        partition->bound = bound;
+
+    }
+
+}
+
+/**
+ * @brief Computes the next window
+ *
+ * A device can only interrupt a partition when one of its tasks finishes an
+ * I/O burst. The bound of every partition is a lower bound of that tick,
+ * and the window ends at the lowest bound of all of them. The tasks that
+ * arrive within the window are handed to their partitions.
+ *
+ * The requests queued on a device are not visited. A queued request only
+ * starts when a channel of its device becomes free, and it is served from
+ * the next tick on, so it never ends before the earliest channel of its
+ * device, whose task already bounds the window. The cost of a window is
+ * then independent of the number of queued requests.
+ */
+static void computeWindow(ParallelRun_t * run) {
+
+    Simulator_t * sim = run->sim;
+    unsigned int clock = run->deviceClock;
+    unsigned int fed = 0, i = 0, j = 0;
+    Partition_t * partition = NULL;
+    Device_t * device = NULL;
+    DeviceChannel_t * channel = NULL;
+    TaskDescriptor_t * desc = NULL;
+
+    for (i = 0; i < run->count; i++) {
+
+        partition = &(run->partitions[i]);
+        partition->bound = UINT_MAX;
+
+        // A pending request completes at least its whole burst later
+        for (j = 0; j < partition->requestCount; j++) {
+
+            desc = (TaskDescriptor_t *)partition->requests[j].pcb;
+
+            boundPartition(partition->requests[j].pcb,
+                           addTicks(partition->requests[j].tick,
+                                    desc->remainingTime));
+
+        }
+
+    }
+
+    for (i = 0; i < sim->deviceCount; i++) {
+
+        device = &(sim->devices[i]);
+
+        for (j = 0; j < device->channelCount; j++) {
+
+            channel = &(device->channels[j]);
+
+            if (channel->task != NULL) {
+
+                desc = (TaskDescriptor_t *)channel->task;
+
+                boundPartition(channel->task,
+                               addTicks(clock, desc->remainingTime != 0 ?
+                                               desc->remainingTime : 1));
+
+            }
+
+        }
+
+    }
+
+    run->target = INT_MAX;
+
+    for (i = 0; i < run->count; i++) {
+
+        if (run->partitions[i].bound < run->target) {
+
+            run->target = run->partitions[i].bound;
+
+        }
+
+    }
+
+    // Tasks go to the partition they are pinned to, or else to one given by
+    // their arrival order. Only a limited number of them is handed out at
+    // once, so that the whole workload is not pulled from the source when
+    // the devices are idle
+    while (sim->nextArrival != NULL && sim->nextArrival->startTime <= run->target) {
+
+        if (fed >= PARTITION_FEED && sim->nextArrival->startTime > clock + 1) {
+
+            run->target = sim->nextArrival->startTime - 1;
+            break;
+
+        }
+
+        // The task stays in the source if it cannot be handed out
+        if (feedPartition(&(run->partitions[getTaskPartition(sim->nextArrival,
+                                                             sim->nextPID,
+                                                             run->count)]),
+                          sim->nextArrival) != 0) {
+
+            sim->failed = 1;
+            break;
+
+        }
+
+        sim->nextPID = sim->nextPID + 1;
+        fed = fed + 1;
+
+        sim->nextArrival = sim->source->next(sim->source);
+
+    }
+
+}
+
+/**
+ * @brief Moves the requests queued on the staging devices of a partition to
+ * its requests.
+ */
+static void collectRequests(Partition_t * partition) {
+
+    Simulator_t * sim = &(partition->sim);
+    DeviceRequest_t * request = NULL;
+    PCB_t * pcb = NULL;
+    unsigned int i = 0;
+
+    for (i = 0; i < sim->deviceCount; i++) {
+
+        while ((pcb = extractFirst(&(partition->staging[i].waitingQueue))) != NULL) {
+
+            // The request is lost, and so is the run
+            if (partition->requestCount == partition->requestCapacity &&
+                growRequests(&(partition->requests),
+                             &(partition->requestCapacity)) != 0) {
+
+                sim->failed = 1;
+                return;
+
+            }
+
+            request = &(partition->requests[partition->requestCount]);
+
+            request->tick = sim->clock;
+            request->cpu = partition->firstCpu + pcb->cpu;
+            request->device = i;
+            request->pcb = pcb;
+
+            partition->requestCount = partition->requestCount + 1;
+
+            boundPartition(pcb, addTicks(sim->clock,
+                                         ((TaskDescriptor_t *)pcb)->remainingTime));
+
+        }
+
+    }
+
+}
+
+/**
+ * @brief Simulates a partition up to the end of the window or its bound
+ *
+ * The partition stops right after simulating the CPUs of its last tick,
+ * since a device may still interrupt it on that tick.
+ */
+static void runPartition(ParallelRun_t * run, Partition_t * partition) {
+
+    Simulator_t * sim = &(partition->sim);
+    unsigned int limit = 0, idleTicks = 0;
+
+    // New tasks may have been handed to the partition
+    if (sim->nextArrival == NULL) {
+
+        sim->nextArrival = sim->source->next(sim->source);
+
+    }
+
+    if (partition->midTick) {
+
+        // The devices have not reached the tick of the partition yet
+        if (sim->clock > run->deviceClock) {
+
+            return;
+
+        }
+
+        finishTick(sim);
+        partition->midTick = 0;
+
+    }
+
+    limit = run->target < partition->bound ? run->target : partition->bound;
+
+    while (sim->clock < limit) {
+
+        idleTicks = ticksToNextCpuEvent(sim) - 1;
+
+        if (idleTicks > limit - sim->clock - 1) {
+
+            idleTicks = limit - sim->clock - 1;
+
+        }
+
+        skipCpuTicks(sim, idleTicks);
+
+        sim->clock = sim->clock + idleTicks + 1;
+
+        simulateCpus(sim);
+
+        collectRequests(partition);
+
+        if (partition->bound < limit) {
+
+            limit = partition->bound;
+
+        }
+
+        if (sim->clock >= limit) {
+
+            partition->midTick = 1;
+            return;
+
+        }
+
+        finishTick(sim);
+
+    }
+
+}
+
+/**
+ * @brief Simulates the partitions assigned to a thread.
+ */
+static void runPartitionShare(ParallelRun_t * run, unsigned int index) {
+
+    unsigned int i = 0;
+
+    for (i = index; i < run->count; i = i + run->threads) {
+
+        runPartition(run, &(run->partitions[i]));
+
+    }
+
+}
+
+static void * partitionWorker(void * arg) {
+
+    PartitionWorker_t * worker = (PartitionWorker_t *)arg;
+    ParallelRun_t * run = worker->run;
+
+    // The barriers are ready once the main thread knows how many workers
+    // it could start
+    pthread_mutex_lock(&(run->lock));
+    pthread_mutex_unlock(&(run->lock));
+
+    for (;;) {
+
+        pthread_barrier_wait(&(run->start));
+
+        if (run->done) {
+
+            break;
+
+        }
+
+        runPartitionShare(run, worker->index);
+
+        pthread_barrier_wait(&(run->end));
+
+    }
+
+    return NULL;
+
+}
+
+/**
+ * @brief Runs all the partitions up to the end of the current window.
+ */
+static void runWindow(ParallelRun_t * run) {
+
+    unsigned int i = 0;
+
+    // While they run on their own, the partitions queue their requests on
+    // the staging devices
+    for (i = 0; i < run->count; i++) {
+
+        run->partitions[i].sim.devices = run->partitions[i].staging;
+
+    }
+
+    if (run->threads > 1 && run->target - run->deviceClock >= PARALLEL_WINDOW) {
+
+        pthread_barrier_wait(&(run->start));
+
+        runPartitionShare(run, 0);
+
+        pthread_barrier_wait(&(run->end));
+
+    } else {
+
+        for (i = 0; i < run->count; i++) {
+
+            runPartition(run, &(run->partitions[i]));
+
+        }
+
+    }
+
+    for (i = 0; i < run->count; i++) {
+
+        run->partitions[i].sim.devices = run->sim->devices;
+
+    }
+
+}
+
+static int compareRequests(const void * a, const void * b) {
+
+    const DeviceRequest_t * first = (const DeviceRequest_t *)a;
+    const DeviceRequest_t * second = (const DeviceRequest_t *)b;
+
+    if (first->tick != second->tick) {
+
+        return first->tick < second->tick ? -1 : 1;
+
+    }
+
+    if (first->cpu != second->cpu) {
+
+        return first->cpu < second->cpu ? -1 : 1;
+
+    }
+
+    return (int)first->device - (int)second->device;
+
+}
+
+/**
+ * @brief Simulates the devices up to a tick
+ *
+ * The requests of all the partitions are applied in the order of the
+ * sequential engines: by tick, and then by CPU. Every partition has already
+ * simulated the CPUs of the tick, and the partitions that may be
+ * interrupted are waiting right there.
+ */
+static void simulateDevicesUntil(ParallelRun_t * run, unsigned int tick) {
+
+    Simulator_t * sim = run->sim;
+    Partition_t * partition = NULL;
+    DeviceRequest_t * request = NULL;
+    unsigned int count = 0, taken = 0, applied = 0;
+    unsigned int next = 0, ticks = 0, i = 0;
+
+    for (i = 0; i < run->count; i++) {
+
+        partition = &(run->partitions[i]);
+
+        for (taken = 0; taken < partition->requestCount &&
+                        partition->requests[taken].tick <= tick; taken++) {
+
+            if (count == run->requestCapacity &&
+                growRequests(&(run->requests), &(run->requestCapacity)) != 0) {
+
+                sim->failed = 1;
+                break;
+
+            }
+
+            run->requests[count] = partition->requests[taken];
+            count = count + 1;
+
+        }
+
+        // The requests of a partition that never queued any are NULL
+        if (taken > 0) {
+
+            memmove(partition->requests, partition->requests + taken,
+                    (partition->requestCount - taken) *
+                    sizeof(DeviceRequest_t));
+
+            partition->requestCount = partition->requestCount - taken;
+
+        }
+
+    }
+
+    if (count > 1) {
+
+        qsort(run->requests, count, sizeof(DeviceRequest_t), compareRequests);
+
+    }
+
+    while (run->deviceClock < tick) {
+
+        // Jump to the next tick in which a burst ends or a request arrives
+        next = tick;
+        ticks = ticksToNextDeviceEvent(sim);
+
+        if (ticks < next - run->deviceClock) {
+
+            next = run->deviceClock + ticks;
+
+        }
+
+        if (applied < count && run->requests[applied].tick < next) {
+
+            next = run->requests[applied].tick;
+
+        }
+
+        skipDeviceTicks(sim, next - run->deviceClock - 1);
+
+        run->deviceClock = next;
+        sim->clock = next;
+
+        // The devices receive the requests in the order of the CPUs
+        while (applied < count && run->requests[applied].tick == next) {
+
+            request = &(run->requests[applied]);
+
+            requestDevice(sim, request->device, request->pcb);
+
+            applied = applied + 1;
+
+        }
+
+        simulateDevices(sim);
+
+    }
+
+}
+
+/**
+ * @brief Checks whether every task has finished.
+ */
+static int isRunFinished(ParallelRun_t * run) {
+
+    Partition_t * partition = NULL;
+    unsigned int i = 0;
+
+    if (run->sim->nextArrival != NULL) {
+
+        return 0;
+
+    }
+
+    for (i = 0; i < run->count; i++) {
+
+        partition = &(run->partitions[i]);
+
+        if (partition->sim.livingTasks != 0 || partition->sim.nextArrival != NULL ||
+            partition->source.first != partition->source.size) {
+
+            return 0;
+
+        }
+
+    }
+
+    return 1;
+
+}
+
+/**
+ * @brief Checks whether the simulation of any partition, or of the devices,
+ * has failed.
+ */
+static int isRunFailed(ParallelRun_t * run) {
+
+    unsigned int i = 0;
+
+    if (simulationFailed(run->sim)) {
+
+        return 1;
+
+    }
+
+    for (i = 0; i < run->count; i++) {
+
+        if (simulationFailed(&(run->partitions[i].sim))) {
+
+            return 1;
+
+        }
+
+    }
+
+    return 0;
+
+}
+
+/**
+ * @brief Releases the first partitions of a run and the run itself.
+ */
+static void freeRun(ParallelRun_t * run, unsigned int count) {
+
+    unsigned int i = 0;
+
+    for (i = 0; i < count; i++) {
+
+        freeSimulator(&(run->partitions[i].sim));
+        free(run->partitions[i].source.tasks);
+        free(run->partitions[i].requests);
+
+    }
+
+    pthread_mutex_destroy(&(run->lock));
+
+    free(run->requests);
+    free(run->partitions);
+
+}
+
+int runPartitions(Simulator_t * sim, TaskSource_t * source) {
+
+    ParallelRun_t run;
+    PartitionWorker_t * workers = NULL;
+    Partition_t * partition = NULL;
+    SimOptions_t options = sim->options;
+    TaskDescriptor_t * desc = NULL;
+    unsigned int i = 0, j = 0, tick = 0;
+    int finished = 0, failed = 0;
+
+    if (resetSimulator(sim, source) != 0) {
+
+        return -1;
+
+    }
+
+    memset(&run, 0, sizeof(ParallelRun_t));
+
+    run.sim = sim;
+    run.count = sim->options.partitions;
+    run.threads = sim->options.threads < run.count ? sim->options.threads : run.count;
+
+    if (run.threads == 0) {
+
+        run.threads = 1;
+
+    }
+
+    run.partitions = (Partition_t *)calloc(run.count, sizeof(Partition_t));
+    workers = (PartitionWorker_t *)calloc(run.threads, sizeof(PartitionWorker_t));
+
+    if (run.partitions == NULL || workers == NULL) {
+
+        perror("Not enough memory for the partitions");
+        free(run.partitions);
+        free(workers);
+        return -1;
+
+    }
+
+    pthread_mutex_init(&(run.lock), NULL);
+
+    // Every partition is a system of its own, but the devices
+    options.cpus = sim->options.cpus / run.count;
+    options.partitions = 1;
+    options.engine = EVENT_ENGINE;
+
+    for (i = 0; i < run.count; i++) {
+
+        partition = &(run.partitions[i]);
+
+        partition->firstCpu = i * options.cpus;
+
+        partition->source.source.next = nextFromPartition;
+        partition->source.source.release = releaseToPartition;
+        partition->source.source.devices = &sharedDevices;
+        partition->source.run = &run;
+
+        for (j = 0; j < sim->deviceCount; j++) {
+
+            partition->staging[j].name = sim->devices[j].name;
+            partition->staging[j].index = j;
+            partition->staging[j].discipline = &fifoDiscipline;
+
+            initQueue(&(partition->staging[j].waitingQueue));
+
+        }
+
+        if (initSimulator(&(partition->sim), &options, sim->trace) != 0 ||
+            resetSimulator(&(partition->sim), &(partition->source.source)) != 0) {
+
+            freeRun(&run, i + 1);
+            free(workers);
+            return -1;
+
+        }
+
+        partition->sim.devices = sim->devices;
+        partition->sim.deviceCount = sim->deviceCount;
+
+    }
+
+    computeWindow(&run);
+
+    for (i = 0; i < run.count; i++) {
+
+        partition = &(run.partitions[i]);
+
+        partition->sim.nextArrival = partition->sim.source->next(partition->sim.source);
+
+        startBootTasks(&(partition->sim));
+
+    }
+
+    if (run.threads > 1) {
+
+        // The workers wait for the barriers on the lock. If a worker cannot
+        // be started, its partitions are shared by the threads that could
+        pthread_mutex_lock(&(run.lock));
+
+        for (i = 1; i < run.threads; i++) {
+
+            workers[i].run = &run;
+            workers[i].index = i;
+
+            if (pthread_create(&(workers[i].thread), NULL, partitionWorker,
+                               &(workers[i])) != 0) {
+
+                break;
+
+            }
+
+        }
+
+        run.threads = i;
+
+        if (run.threads > 1) {
+
+            pthread_barrier_init(&(run.start), NULL, run.threads);
+            pthread_barrier_init(&(run.end), NULL, run.threads);
+
+        }
+
+        pthread_mutex_unlock(&(run.lock));
+
+    }
+
+    for (;;) {
+
+        runWindow(&run);
+
+        // Every partition has simulated, at least, the CPUs up to this tick
+        tick = UINT_MAX;
+
+        for (i = 0; i < run.count; i++) {
+
+            if (run.partitions[i].sim.clock < tick) {
+
+                tick = run.partitions[i].sim.clock;
+
+            }
+
+        }
+
+        simulateDevicesUntil(&run, tick);
+
+        if (isRunFinished(&run) || run.deviceClock >= INT_MAX ||
+            isRunFailed(&run)) {
+
+            break;
+
+        }
+
+        computeWindow(&run);
+
+    }
+
+    if (run.threads > 1) {
+
+        run.done = 1;
+
+        pthread_barrier_wait(&(run.start));
+
+        for (i = 1; i < run.threads; i++) {
+
+            pthread_join(workers[i].thread, NULL);
+
+        }
+
+        pthread_barrier_destroy(&(run.start));
+        pthread_barrier_destroy(&(run.end));
+
+    }
+
+    // Put the results of the partitions together. If every task finished,
+    // the simulation ended on the tick of the last exit
+    finished = isRunFinished(&run);
+    failed = isRunFailed(&run);
+
+    sim->clock = finished ? 0 : run.deviceClock;
+    sim->nextPID = 0;
+    sim->livingTasks = 0;
+
+    for (i = 0; i < run.count; i++) {
+
+        partition = &(run.partitions[i]);
+
+        // Partitions stopped at the iteration limit finish their last tick
+        if (!finished && partition->midTick) {
+
+            finishTick(&(partition->sim));
+
+        }
+
+        if (finished && partition->source.lastExit > sim->clock) {
+
+            sim->clock = partition->source.lastExit;
+
+        }
+
+        sim->nextPID = sim->nextPID + partition->sim.nextPID;
+        sim->livingTasks = sim->livingTasks + partition->sim.livingTasks;
+
+        for (j = 0; j < options.cpus; j++) {
+
+            sim->cpus[partition->firstCpu + j].busyTicks =
+                partition->sim.cpus[j].busyTicks;
+
+        }
+
+        mergeMetrics(&(sim->metrics), &(partition->sim.metrics));
+
+        // The tasks that never arrived are unfinished too
+        desc = partition->sim.nextArrival;
+
+        while (desc != NULL) {
+
+            sim->livingTasks = sim->livingTasks + 1;
+
+            source->release(source, desc);
+            desc = nextFromPartition(&(partition->source.source));
+
+        }
+
+    }
+
+    while (sim->nextArrival != NULL) {
+
+        sim->livingTasks = sim->livingTasks + 1;
+
+        source->release(source, sim->nextArrival);
+        sim->nextArrival = source->next(source);
+
+    }
+
+    freeRun(&run, run.count);
+    free(workers);
+
+    return failed || simulationFailed(sim) ? -1 : 0;
+
+}
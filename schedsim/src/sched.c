@@ -0,0 +1,41 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <sched.h>
+
+/** Available scheduling policies, the first one is the default */
+static const SchedPolicy_t * const policies[] = {
+    &fifoPolicy,
+    &rrPolicy,
+    &prioPolicy,
+    &mlfqPolicy,
+    &cfsPolicy,
+    &sjfPolicy,
+    &srtfPolicy,
+    &sjfExpPolicy,
+    NULL
+};
+
+const SchedPolicy_t * findPolicy(const char * name) {
+
+    int i = 0;
+
+    for (i = 0; policies[i] != NULL; i++) {
+
+        if (strcmp(policies[i]->name, name) == 0) {
+
+            return policies[i];
+
+        }
+
+    }
+
+    return NULL;
+
+}
+
+const SchedPolicy_t * const * getPolicies() {
+
+    return policies;
+
+}
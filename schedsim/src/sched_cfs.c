@@ -0,0 +1,263 @@
+#include <stdio.h>
+#include <limits.h>
+
+#include <os.h>
+#include <sched.h>
+
+/**
+ * Virtual runtime gained by a task of priority 0 on every tick it runs. A
+ * task of priority p gains VRUNTIME_SCALE / (p + 1) per tick, so higher
+ * priorities get a larger share of the CPU.
+ */
+#define VRUNTIME_SCALE 1024ULL
+
+/*
+ * The virtual runtime of a task is the key of its PCB, and the ready queues
+ * are ordered by key. The virtual runtime of the running task is only
+ * updated when it leaves the CPU: in between, it is computed from the
+ * ticks elapsed since it was dispatched, so that it does not depend on how
+ * often the clock ticks are simulated.
+ */
+
+static unsigned long long weightOf(PCB_t * pcb) {
+
+    return getPriority(pcb) + 1ULL;
+
+}
+
+/**
+ * @brief Returns the current virtual runtime of the running task of a CPU
+ */
+static unsigned long long currentVruntime(Simulator_t * sim, unsigned int cpu,
+                                          PCB_t * pcb) {
+
+    unsigned long long ran = getClock(sim) - getDispatchTime(sim, cpu);
+
+    return getKey(pcb) + ran * VRUNTIME_SCALE / weightOf(pcb);
+
+}
+
+/**
+ * @brief Returns the minimum virtual runtime of the tasks of a CPU
+ *
+ * @return The minimum virtual runtime of the running task and the ready
+ * ones, or 0 if the CPU has no task.
+ */
+static unsigned long long minVruntime(Simulator_t * sim, unsigned int cpu) {
+
+    PCB_t * runningTask = getRunningTask(sim, cpu);
+    PCB_t * first = getReadyQueue(sim, cpu)->first;
+    unsigned long long vruntime = ULLONG_MAX;
+
+    if (runningTask != NULL) {
+
+        vruntime = currentVruntime(sim, cpu, runningTask);
+
+    }
+
+    if (first != NULL && getKey(first) < vruntime) {
+
+        vruntime = getKey(first);
+
+    }
+
+    return vruntime != ULLONG_MAX ? vruntime : 0;
+
+}
+
+static PCB_t * schedule(Simulator_t * sim, unsigned int cpu) {
+
+    // The first element of the ready queue is the task with the lowest
+    // virtual runtime, i.e. the leftmost node of the tree
+    return extractFirst(getReadyQueue(sim, cpu));
+
+}
+
+static void runTask(Simulator_t * sim, unsigned int cpu, PCB_t * pcb) {
+
+    setState(pcb, RUNNING);
+    dispatch(sim, cpu, pcb);
+
+}
+
+/**
+ * @brief Dispatches the next task of a CPU, if there is any
+ */
+static void runNextTask(Simulator_t * sim, unsigned int cpu) {
+
+    PCB_t * nextToRun = schedule(sim, cpu);
+
+    if (nextToRun != NULL) {
+
+        runTask(sim, cpu, nextToRun);
+
+    }
+
+}
+
+/**
+ * @brief Makes a task ready to run on a CPU
+ *
+ * A task that arrives, returns from a device or comes from another CPU
+ * starts at least at the minimum virtual runtime of the CPU, so it cannot
+ * monopolize the CPU with the credit it has accumulated elsewhere.
+ */
+static void readyTask(Simulator_t * sim, unsigned int cpu, PCB_t * pcb) {
+
+    unsigned long long vruntime = minVruntime(sim, cpu);
+
+    if (getKey(pcb) < vruntime) {
+
+        setKey(pcb, vruntime);
+
+    }
+
+    if (getRunningTask(sim, cpu) != NULL) {
+
+        setState(pcb, READY);
+        addPCBByKey(getReadyQueue(sim, cpu), pcb);
+
+    } else {
+
+        runTask(sim, cpu, pcb);
+
+    }
+
+}
+
+static void startTask(Simulator_t * sim, unsigned int cpu, PCB_t * pcb) {
+
+    readyTask(sim, cpu, pcb);
+
+}
+
+static void exitTask(Simulator_t * sim, unsigned int cpu, PCB_t * pcb) {
+
+    // Set the exit task to finished state
+    setState(pcb, FINISHED);
+
+    // A task that finishes on a device leaves its CPU alone
+    if (getRunningTask(sim, cpu) != NULL) {
+
+        return;
+
+    }
+
+    runNextTask(sim, cpu);
+
+}
+
+static void clockTick(Simulator_t * sim, unsigned int cpu, PCB_t * pcb) {
+
+    PCB_t * first = getReadyQueue(sim, cpu)->first;
+    unsigned long long vruntime = 0;
+
+    if (pcb == NULL || first == NULL) {
+
+        return;
+
+    }
+
+    // The running task is preempted once it is ahead of the leftmost task
+    // by more than the granularity, which is a quantum of a task of
+    // priority 0
+    vruntime = currentVruntime(sim, cpu, pcb);
+
+    if (vruntime > getKey(first) + getQuantum(sim) * VRUNTIME_SCALE) {
+
+        setKey(pcb, vruntime);
+
+        setState(pcb, READY);
+        addPCBByKey(getReadyQueue(sim, cpu), pcb);
+
+        runNextTask(sim, cpu);
+
+    }
+
+}
+
+static unsigned int nextClockEvent(Simulator_t * sim, unsigned int cpu,
+                                   PCB_t * pcb) {
+
+    PCB_t * first = getReadyQueue(sim, cpu)->first;
+    unsigned long long limit = 0, ticks = 0, ran = 0;
+
+    if (pcb == NULL || first == NULL) {
+
+        return UINT_MAX;
+
+    }
+
+    // The task is preempted after running the first number of ticks whose
+    // virtual runtime exceeds the limit
+    limit = getKey(first) + getQuantum(sim) * VRUNTIME_SCALE;
+    ran = getClock(sim) - getDispatchTime(sim, cpu);
+
+    if (getKey(pcb) > limit) {
+
+        return 1;
+
+    }
+
+    if (limit - getKey(pcb) + 1 > ULLONG_MAX / weightOf(pcb)) {
+
+        return UINT_MAX;
+
+    }
+
+    ticks = ((limit - getKey(pcb) + 1) * weightOf(pcb) + VRUNTIME_SCALE - 1) /
+            VRUNTIME_SCALE;
+
+    if (ticks <= ran) {
+
+        return 1;
+
+    }
+
+    return ticks - ran < UINT_MAX ? ticks - ran : UINT_MAX;
+
+}
+
+static void yieldDevice(Simulator_t * sim, unsigned int cpu,
+                        unsigned int device, PCB_t * pcb) {
+
+    // Charge the task for the ticks it has run
+    setKey(pcb, currentVruntime(sim, cpu, pcb));
+
+    // Set the task to waiting state. The simulator hands it to the device
+    setState(pcb, WAITING);
+
+    // Since the task has abandoned the CPU, we need to select another one to
+    // run
+    runNextTask(sim, cpu);
+
+}
+
+static void ioDeviceIRQ(Simulator_t * sim, unsigned int cpu,
+                        unsigned int device, PCB_t * pcb) {
+
+    readyTask(sim, cpu, pcb);
+
+}
+
+static void migrateTask(Simulator_t * sim, unsigned int cpu, PCB_t * pcb) {
+
+    // The task is already in ready state
+    readyTask(sim, cpu, pcb);
+
+}
+
+const SchedPolicy_t cfsPolicy = {
+
+    .name = "cfs",
+
+    .schedule = schedule,
+    .startTask = startTask,
+    .exitTask = exitTask,
+    .clockTick = clockTick,
+    .nextClockEvent = nextClockEvent,
+    .yieldDevice = yieldDevice,
+    .ioDeviceIRQ = ioDeviceIRQ,
+    .migrateTask = migrateTask
+
+};
@@ -1,29 +1,21 @@
 #include <stdio.h>
+#include <limits.h>
 
 #include <os.h>
 #include <sched.h>
 
-/** Pointer to the Ready Task Queue */
-extern TaskQueue_t * readyQueue;
-
-/** Pointer to the Hard Disk Waiting Task Queue */
-extern TaskQueue_t * hardDiskWaitingQueue;
-
-/** Pointer to the Keyboard Waiting Task Queue */
-extern TaskQueue_t * keyboardWaitingQueue;
-
-PCB_t * schedule() {
+static PCB_t * schedule(Simulator_t * sim, unsigned int cpu) {
 
     // Return the first element of the ready queue
-    return extractFirst(readyQueue);
+    return extractFirst(getReadyQueue(sim, cpu));
 
 }
 
-void startTask(PCB_t * pcb) {
+static void startTask(Simulator_t * sim, unsigned int cpu, PCB_t * pcb) {
 
     // runningTask = task that is currently being executed or NULL if no task
     // is currently running on the CPU
-    PCB_t * runningTask = getRunningTask();
+    PCB_t * runningTask = getRunningTask(sim, cpu);
 
     // Check if there was already a task in execution
 
@@ -32,28 +24,35 @@ void startTask(PCB_t * pcb) {
         // If there was a task already running, put the new one on ready
         // state and append it to the end of the ready queue
         setState(pcb, READY);
-        appendPCB(readyQueue, pcb);
+        appendPCB(getReadyQueue(sim, cpu), pcb);
 
     } else {
 
         // If there was no task previously running, set the new one to running
         // state and dispatch it to the CPU
         setState(pcb, RUNNING);
-        dispatch(pcb);
+        dispatch(sim, cpu, pcb);
 
     }
 
 }
 
-void exitTask(PCB_t * pcb) {
+static void exitTask(Simulator_t * sim, unsigned int cpu, PCB_t * pcb) {
 
     PCB_t * nextToRun = NULL;
 
     // Set the exit task to finished state
     setState(pcb, FINISHED);
 
+    // A task that finishes on a device leaves its CPU alone
+    if (getRunningTask(sim, cpu) != NULL) {
+
+        return;
+
+    }
+
     // Get the next task to run
-    nextToRun = schedule();
+    nextToRun = schedule(sim, cpu);
 
     // Check if there was a candidate to running state
     if (nextToRun != NULL) {
@@ -61,44 +60,38 @@ void exitTask(PCB_t * pcb) {
         // If there is a candidate, set it to running state and dispatch it to
         // the CPU
         setState(nextToRun, RUNNING);
-        dispatch(nextToRun);
+        dispatch(sim, cpu, nextToRun);
 
     }
 
 }
 
-void clockTick(PCB_t * pcb) {
+static void clockTick(Simulator_t * sim, unsigned int cpu, PCB_t * pcb) {
 
     // Nothing to do with a pure FIFO scheduling policy
     return;
 
 }
 
-void yieldHardDisk(PCB_t * pcb) {
+static unsigned int nextClockEvent(Simulator_t * sim, unsigned int cpu,
+                                   PCB_t * pcb) {
 
-    PCB_t * nextToRun = NULL;
-
-    // Set the task to waiting state
-    setState(pcb, WAITING);
-
-    // Check if there was already a task using the hard disk
-    if (getHardDiskWaitingTask() != NULL) {
+    // The clock tick never triggers anything with a pure FIFO scheduling policy
+    return UINT_MAX;
 
-        // If there was a task, enqueue the current one on the hard disk
-        // waiting queue
-        appendPCB(hardDiskWaitingQueue, pcb);
+}
 
-    } else {
+static void yieldDevice(Simulator_t * sim, unsigned int cpu,
+                        unsigned int device, PCB_t * pcb) {
 
-        // There was not any task using the hard disk, so make the current
-        // task to use it
-        programHardDisk(pcb);
+    PCB_t * nextToRun = NULL;
 
-    }
+    // Set the task to waiting state. The simulator hands it to the device
+    setState(pcb, WAITING);
 
     // Since the task has abandoned the CPU, we need to select another one to
     // run
-    nextToRun = schedule();
+    nextToRun = schedule(sim, cpu);
 
     // Check if there is a candidate to running state
     if (nextToRun != NULL) {
@@ -106,27 +99,18 @@ void yieldHardDisk(PCB_t * pcb) {
         // If there is a candidate, set it to running state and dispatch it to
         // the CPU
         setState(nextToRun, RUNNING);
-        dispatch(nextToRun);
+        dispatch(sim, cpu, nextToRun);
 
     }
 
 }
 
-void ioHardDiskIRQ(PCB_t * pcb) {
-
-    // An IO operation on the hard disk has finished. First, we need to
-    // check if there were tasks waiting for the previous operation to
-    // finish
-    PCB_t * waiting = extractFirst(hardDiskWaitingQueue);
-    PCB_t * runningTask = getRunningTask();
-
-    if (waiting != NULL) {
+static void ioDeviceIRQ(Simulator_t * sim, unsigned int cpu,
+                        unsigned int device, PCB_t * pcb) {
 
-        // If there were a task waiting for the previous operation to
-        // finish, then program it to use the hard disk
-        programHardDisk(waiting);
-
-    }
+    // An IO operation has finished, and the device has already moved on to
+    // the next waiting task
+    PCB_t * runningTask = getRunningTask(sim, cpu);
 
     // Check if there was already a task in execution
     if (runningTask != NULL) {
@@ -134,88 +118,47 @@ void ioHardDiskIRQ(PCB_t * pcb) {
         // If there was a task already running, put this one on ready
         // state and append it to the end of the ready queue
         setState(pcb, READY);
-        appendPCB(readyQueue, pcb);
+        appendPCB(getReadyQueue(sim, cpu), pcb);
 
     } else {
 
         // If there was no task previously running, set this one to running
         // state and dispatch it to the CPU
         setState(pcb, RUNNING);
-        dispatch(pcb);
+        dispatch(sim, cpu, pcb);
 
     }
 
 }
 
-void yieldKeyboard(PCB_t * pcb) {
-
-    PCB_t * nextToRun = NULL;
-
-    // Set the task to waiting state
-    setState(pcb, WAITING);
+static void migrateTask(Simulator_t * sim, unsigned int cpu, PCB_t * pcb) {
 
-    // Check if there was already a task waiting for the keyboard
-    if (getKeyboardWaitingTask() != NULL) {
+    // The task is already in ready state. If the new CPU is idle, it runs
+    // the task straight away; otherwise the task waits on its ready queue
+    if (getRunningTask(sim, cpu) != NULL) {
 
-        // If there was a task, enqueue the current one on the keyboard
-        // waiting queue
-        appendPCB(keyboardWaitingQueue, pcb);
+        appendPCB(getReadyQueue(sim, cpu), pcb);
 
     } else {
 
-        // There was not any task waiting for the keyboard, so make the 
-        // current task to wait for it
-        programKeyboard(pcb);
-
-    }
-
-    // Since the task has abandoned the CPU, we need to select another one to
-    // run
-    nextToRun = schedule();
-
-    // Check if there is a candidate to running state
-    if (nextToRun != NULL) {
-
-        // If there is a candidate, set it to running state and dispatch it to
-        // the CPU
-        setState(nextToRun, RUNNING);
-        dispatch(nextToRun);
+        setState(pcb, RUNNING);
+        dispatch(sim, cpu, pcb);
 
     }
 
 }
 
-void ioKeyboardIRQ(PCB_t * pcb) {
-
-    // An IO operation on the keyboard has finished. First, we need to
-    // check if there were tasks waiting for the previous operation to
-    // finish
-    PCB_t * waiting = extractFirst(keyboardWaitingQueue);
-    PCB_t * runningTask = getRunningTask();
-
-    if (waiting != NULL) {
-
-        // If there were a task waiting for the previous operation to
-        // finish, then program it to wait for the keyboard
-        programKeyboard(waiting);
-
-    }
-
-    // Check if there was already a task in execution
-    if (runningTask != NULL) {
-    
-        // If there was a task already running, put this one on ready
-        // state and append it to the end of the ready queue
-        setState(pcb, READY);
-        appendPCB(readyQueue, pcb);
-
-    } else {
+const SchedPolicy_t fifoPolicy = {
 
-        // If there was no task previously running, set this one to running
-        // state and dispatch it to the CPU
-        setState(pcb, RUNNING);
-        dispatch(pcb);
+    .name = "fifo",
 
-    }
+    .schedule = schedule,
+    .startTask = startTask,
+    .exitTask = exitTask,
+    .clockTick = clockTick,
+    .nextClockEvent = nextClockEvent,
+    .yieldDevice = yieldDevice,
+    .ioDeviceIRQ = ioDeviceIRQ,
+    .migrateTask = migrateTask
 
-}
+};
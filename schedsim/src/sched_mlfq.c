@@ -0,0 +1,283 @@
+#include <stdio.h>
+#include <limits.h>
+
+#include <os.h>
+#include <sched.h>
+
+/*
+ * The level of a task is stored in the priority of its PCB: the top level,
+ * 0, has the highest priority. A single ready queue ordered by priority is
+ * then a multilevel queue, with the tasks of every level in FIFO order.
+ */
+
+static unsigned int getLevel(Simulator_t * sim, PCB_t * pcb) {
+
+    return getLevels(sim) - 1 - getPriority(pcb);
+
+}
+
+/**
+ * @brief Returns the quantum of a task on a level
+ *
+ * The quantum of the top level is the one of the task, and it doubles from
+ * one level to the next.
+ */
+static unsigned int levelQuantum(Simulator_t * sim, PCB_t * pcb,
+                                 unsigned int level) {
+
+    unsigned int quantum = getTaskQuantum(sim, pcb);
+
+    if (quantum > (UINT_MAX >> level)) {
+
+        return UINT_MAX;
+
+    }
+
+    return quantum << level;
+
+}
+
+/**
+ * @brief Moves a task to a level, with a full quantum of that level
+ *
+ * The task must not be in any queue ordered by priority.
+ */
+static void setLevel(Simulator_t * sim, PCB_t * pcb, unsigned int level) {
+
+    setPriority(pcb, getLevels(sim) - 1 - level);
+    setTimeslice(pcb, levelQuantum(sim, pcb, level));
+
+}
+
+static PCB_t * schedule(Simulator_t * sim, unsigned int cpu) {
+
+    // The first element of the ready queue is the oldest task of the highest
+    // level that has any
+    return extractFirst(getReadyQueue(sim, cpu));
+
+}
+
+/**
+ * @brief Dispatches a task to a CPU with what is left of its timeslice
+ *
+ * The timeslice expires getTimeslice() ticks after getDispatchTime().
+ */
+static void runTask(Simulator_t * sim, unsigned int cpu, PCB_t * pcb) {
+
+    recordLevelDispatch(sim, getLevel(sim, pcb), pcb);
+
+    setState(pcb, RUNNING);
+    dispatch(sim, cpu, pcb);
+
+}
+
+/**
+ * @brief Dispatches the next task of a CPU, if there is any
+ */
+static void runNextTask(Simulator_t * sim, unsigned int cpu) {
+
+    PCB_t * nextToRun = schedule(sim, cpu);
+
+    if (nextToRun != NULL) {
+
+        runTask(sim, cpu, nextToRun);
+
+    }
+
+}
+
+/**
+ * @brief Makes a task ready to run on a CPU
+ *
+ * A task on a higher level than the running one preempts it. The preempted
+ * task keeps the rest of its timeslice for when it runs again.
+ */
+static void readyTask(Simulator_t * sim, unsigned int cpu, PCB_t * pcb) {
+
+    PCB_t * runningTask = getRunningTask(sim, cpu);
+    unsigned int used = 0;
+
+    if (runningTask == NULL) {
+
+        runTask(sim, cpu, pcb);
+
+    } else if (getPriority(pcb) > getPriority(runningTask)) {
+
+        used = getClock(sim) - getDispatchTime(sim, cpu);
+        setTimeslice(runningTask, getTimeslice(runningTask) - used);
+
+        setState(runningTask, READY);
+        addPCBByPriority(getReadyQueue(sim, cpu), runningTask);
+
+        runTask(sim, cpu, pcb);
+
+    } else {
+
+        setState(pcb, READY);
+        addPCBByPriority(getReadyQueue(sim, cpu), pcb);
+
+    }
+
+}
+
+/**
+ * @brief Moves every task of a CPU back to the top level
+ *
+ * The ready tasks keep their relative order and get a full quantum of the
+ * top level. The running task keeps its timeslice. Tasks waiting for a
+ * device are not boosted, but they go up a level when they yield the CPU.
+ */
+static void boostTasks(Simulator_t * sim, unsigned int cpu) {
+
+    TaskQueue_t * readyQueue = getReadyQueue(sim, cpu);
+    PCB_t * runningTask = getRunningTask(sim, cpu);
+    TaskQueue_t boosted;
+    PCB_t * pcb = NULL;
+
+    initQueue(&boosted);
+
+    while ((pcb = extractFirst(readyQueue)) != NULL) {
+
+        appendPCB(&boosted, pcb);
+
+    }
+
+    while ((pcb = extractFirst(&boosted)) != NULL) {
+
+        setLevel(sim, pcb, 0);
+        addPCBByPriority(readyQueue, pcb);
+
+    }
+
+    if (runningTask != NULL) {
+
+        setPriority(runningTask, getLevels(sim) - 1);
+
+    }
+
+}
+
+static void startTask(Simulator_t * sim, unsigned int cpu, PCB_t * pcb) {
+
+    // New tasks start on the top level
+    setLevel(sim, pcb, 0);
+
+    readyTask(sim, cpu, pcb);
+
+}
+
+static void exitTask(Simulator_t * sim, unsigned int cpu, PCB_t * pcb) {
+
+    // Set the exit task to finished state
+    setState(pcb, FINISHED);
+
+    // A task that finishes on a device leaves its CPU alone
+    if (getRunningTask(sim, cpu) != NULL) {
+
+        return;
+
+    }
+
+    runNextTask(sim, cpu);
+
+}
+
+static void clockTick(Simulator_t * sim, unsigned int cpu, PCB_t * pcb) {
+
+    unsigned int level = 0;
+
+    // A task that uses up its timeslice goes down a level
+    if (pcb != NULL &&
+        getClock(sim) - getDispatchTime(sim, cpu) >= getTimeslice(pcb)) {
+
+        level = getLevel(sim, pcb);
+
+        setLevel(sim, pcb, level + 1 < getLevels(sim) ? level + 1 : level);
+
+        setState(pcb, READY);
+        addPCBByPriority(getReadyQueue(sim, cpu), pcb);
+
+        runNextTask(sim, cpu);
+
+    }
+
+    if (getBoost(sim) != 0 && getClock(sim) % getBoost(sim) == 0) {
+
+        boostTasks(sim, cpu);
+
+    }
+
+}
+
+static unsigned int nextClockEvent(Simulator_t * sim, unsigned int cpu,
+                                   PCB_t * pcb) {
+
+    unsigned int ticks = UINT_MAX;
+    unsigned int boost = 0;
+
+    // The running task is demoted when its timeslice expires
+    if (pcb != NULL) {
+
+        ticks = getTimeslice(pcb) - (getClock(sim) - getDispatchTime(sim, cpu));
+
+    }
+
+    // A boost only matters if the CPU has any task
+    if (getBoost(sim) != 0 &&
+        (pcb != NULL || getSize(getReadyQueue(sim, cpu)) != 0)) {
+
+        boost = getBoost(sim) - getClock(sim) % getBoost(sim);
+        ticks = boost < ticks ? boost : ticks;
+
+    }
+
+    return ticks;
+
+}
+
+static void yieldDevice(Simulator_t * sim, unsigned int cpu,
+                        unsigned int device, PCB_t * pcb) {
+
+    unsigned int level = getLevel(sim, pcb);
+
+    // A task that leaves the CPU before its timeslice expires goes up a level
+    setLevel(sim, pcb, level > 0 ? level - 1 : 0);
+
+    // Set the task to waiting state. The simulator hands it to the device
+    setState(pcb, WAITING);
+
+    // Since the task has abandoned the CPU, we need to select another one to
+    // run
+    runNextTask(sim, cpu);
+
+}
+
+static void ioDeviceIRQ(Simulator_t * sim, unsigned int cpu,
+                        unsigned int device, PCB_t * pcb) {
+
+    // The task may preempt the running one
+    readyTask(sim, cpu, pcb);
+
+}
+
+static void migrateTask(Simulator_t * sim, unsigned int cpu, PCB_t * pcb) {
+
+    // The task is already in ready state, and it keeps its level
+    readyTask(sim, cpu, pcb);
+
+}
+
+const SchedPolicy_t mlfqPolicy = {
+
+    .name = "mlfq",
+
+    .schedule = schedule,
+    .startTask = startTask,
+    .exitTask = exitTask,
+    .clockTick = clockTick,
+    .nextClockEvent = nextClockEvent,
+    .yieldDevice = yieldDevice,
+    .ioDeviceIRQ = ioDeviceIRQ,
+    .migrateTask = migrateTask
+
+};
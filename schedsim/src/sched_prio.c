@@ -1,63 +1,200 @@
 #include <stdio.h>
+#include <limits.h>
 
 #include <os.h>
 #include <sched.h>
 
-/** Pointer to the Ready Task Queue */
-extern TaskQueue_t * readyQueue;
+static PCB_t * schedule(Simulator_t * sim, unsigned int cpu) {
 
-/** Pointer to the Hard Disk Waiting Task Queue */
-extern TaskQueue_t * hardDiskWaitingQueue;
+    // The ready queue is ordered by priority, so the first element is the
+    // task with the highest priority
+    return extractFirst(getReadyQueue(sim, cpu));
 
-/** Pointer to the Keyboard Waiting Task Queue */
-extern TaskQueue_t * keyboardWaitingQueue;
+}
 
-PCB_t * schedule() {
+/**
+ * @brief Dispatches a task to a CPU
+ *
+ * A task runs with the priority of its descriptor, whatever it aged while
+ * it was waiting on the ready queue.
+ */
+static void runTask(Simulator_t * sim, unsigned int cpu, PCB_t * pcb) {
 
-    // Return the first element of the ready queue
-    return extractFirst(readyQueue);
+    setPriority(pcb, getBasePriority(sim, pcb));
+    setState(pcb, RUNNING);
+    dispatch(sim, cpu, pcb);
 
 }
 
-void startTask(PCB_t * pcb) {
+/**
+ * @brief Dispatches the next task of a CPU, if there is any
+ */
+static void runNextTask(Simulator_t * sim, unsigned int cpu) {
+
+    PCB_t * nextToRun = schedule(sim, cpu);
+
+    if (nextToRun != NULL) {
 
-    // TODO: Complete the function
+        runTask(sim, cpu, nextToRun);
+
+    }
 
 }
 
-void exitTask(PCB_t * pcb) {
+/**
+ * @brief Makes a task ready to run on a CPU
+ *
+ * If the task has a higher priority than the running one, it preempts it.
+ * Otherwise, it waits on the ready queue behind the tasks with the same or
+ * a higher priority.
+ */
+static void readyTask(Simulator_t * sim, unsigned int cpu, PCB_t * pcb) {
+
+    PCB_t * runningTask = getRunningTask(sim, cpu);
+
+    if (runningTask == NULL) {
+
+        runTask(sim, cpu, pcb);
+
+    } else if (getPriority(pcb) > getPriority(runningTask)) {
+
+        // The preempted task goes back to the ready queue
+        setState(runningTask, READY);
+        addPCBByPriority(getReadyQueue(sim, cpu), runningTask);
+
+        runTask(sim, cpu, pcb);
+
+    } else {
+
+        setState(pcb, READY);
+        addPCBByPriority(getReadyQueue(sim, cpu), pcb);
 
-    // TODO: Complete the function
+    }
 
 }
 
-void clockTick(PCB_t * pcb) {
+/**
+ * Highest priority that a task can reach by aging. It is below the last
+ * bucket of the queues, which holds every greater priority in a single
+ * bucket, so aging never piles the ready tasks up there.
+ */
+#define MAX_AGED_PRIORITY (QUEUE_BUCKETS - 2)
 
-    // Nothing to do with a priority-based scheduling policy
-    return;
+/**
+ * @brief Raises by one the priority of every ready task of a CPU
+ *
+ * Tasks already at MAX_AGED_PRIORITY or above do not age. Every other task
+ * is raised by the same amount, so they keep their place on the queue.
+ */
+static void ageReadyTasks(Simulator_t * sim, unsigned int cpu) {
+
+    raisePriorities(getReadyQueue(sim, cpu), MAX_AGED_PRIORITY);
 
 }
 
-void yieldHardDisk(PCB_t * pcb) {
+static void startTask(Simulator_t * sim, unsigned int cpu, PCB_t * pcb) {
 
-    // TODO: Complete the function
+    readyTask(sim, cpu, pcb);
 
 }
 
-void ioHardDiskIRQ(PCB_t * pcb) {
+static void exitTask(Simulator_t * sim, unsigned int cpu, PCB_t * pcb) {
+
+    // Set the exit task to finished state
+    setState(pcb, FINISHED);
+
+    // A task that finishes on a device leaves its CPU alone
+    if (getRunningTask(sim, cpu) != NULL) {
 
-    // TODO: Complete the function
+        return;
+
+    }
+
+    runNextTask(sim, cpu);
 
 }
 
-void yieldKeyboard(PCB_t * pcb) {
+static void clockTick(Simulator_t * sim, unsigned int cpu, PCB_t * pcb) {
+
+    PCB_t * runningTask = getRunningTask(sim, cpu);
+    TaskQueue_t * readyQueue = getReadyQueue(sim, cpu);
+    PCB_t * first = NULL;
+
+    // The ready tasks age every getAging() ticks of the clock
+    if (getAging(sim) == 0 || getClock(sim) % getAging(sim) != 0 ||
+        getSize(readyQueue) == 0) {
+
+        return;
+
+    }
+
+    ageReadyTasks(sim, cpu);
+
+    // A task that has aged above the running one preempts it
+    first = readyQueue->first;
 
-    // TODO: Complete the function
+    if (runningTask != NULL && getPriority(first) > getPriority(runningTask)) {
+
+        readyTask(sim, cpu, extractFirst(readyQueue));
+
+    }
+
+}
+
+static unsigned int nextClockEvent(Simulator_t * sim, unsigned int cpu,
+                                   PCB_t * pcb) {
+
+    // Without aging, or without ready tasks, the clock tick never triggers
+    // anything
+    if (getAging(sim) == 0 || getSize(getReadyQueue(sim, cpu)) == 0) {
+
+        return UINT_MAX;
+
+    }
+
+    return getAging(sim) - getClock(sim) % getAging(sim);
+
+}
+
+static void yieldDevice(Simulator_t * sim, unsigned int cpu,
+                        unsigned int device, PCB_t * pcb) {
+
+    // Set the task to waiting state. The simulator hands it to the device
+    setState(pcb, WAITING);
+
+    // Since the task has abandoned the CPU, we need to select another one to
+    // run
+    runNextTask(sim, cpu);
 
 }
 
-void ioKeyboardIRQ(PCB_t * pcb) {
+static void ioDeviceIRQ(Simulator_t * sim, unsigned int cpu,
+                        unsigned int device, PCB_t * pcb) {
 
-    // TODO: Complete the function
+    // The task may preempt the running one
+    readyTask(sim, cpu, pcb);
 
 }
+
+static void migrateTask(Simulator_t * sim, unsigned int cpu, PCB_t * pcb) {
+
+    // The task is already in ready state, and it keeps the priority it has
+    // aged so far
+    readyTask(sim, cpu, pcb);
+
+}
+
+const SchedPolicy_t prioPolicy = {
+
+    .name = "prio",
+
+    .schedule = schedule,
+    .startTask = startTask,
+    .exitTask = exitTask,
+    .clockTick = clockTick,
+    .nextClockEvent = nextClockEvent,
+    .yieldDevice = yieldDevice,
+    .ioDeviceIRQ = ioDeviceIRQ,
+    .migrateTask = migrateTask
+
+};
@@ -1,102 +1,162 @@
 #include <stdio.h>
+#include <limits.h>
 
 #include <os.h>
 #include <sched.h>
 
-/** Pointer to the Ready Task Queue */
-extern TaskQueue_t * readyQueue;
+static PCB_t * schedule(Simulator_t * sim, unsigned int cpu) {
 
-/** Pointer to the Hard Disk Waiting Task Queue */
-extern TaskQueue_t * hardDiskWaitingQueue;
+    // Return the first element of the ready queue
+    return extractFirst(getReadyQueue(sim, cpu));
 
-/** Pointer to the Keyboard Waiting Task Queue */
-extern TaskQueue_t * keyboardWaitingQueue;
+}
 
-#define TIMESLICE 2
+/**
+ * @brief Dispatches a task to a CPU with a fresh timeslice
+ *
+ * The timeslice is not consumed tick by tick: it expires getTimeslice()
+ * ticks after getDispatchTime(), which is an event the engines can jump to.
+ */
+static void runTask(Simulator_t * sim, unsigned int cpu, PCB_t * pcb) {
 
-PCB_t * schedule() {
+    setState(pcb, RUNNING);
+    setTimeslice(pcb, getTaskQuantum(sim, pcb));
+    dispatch(sim, cpu, pcb);
 
-    // Return the first element of the ready queue
-    return extractFirst(readyQueue);
+}
+
+/**
+ * @brief Makes a task ready to run on a CPU
+ *
+ * If the CPU is idle the task runs straight away; otherwise it waits at the
+ * end of the ready queue.
+ */
+static void readyTask(Simulator_t * sim, unsigned int cpu, PCB_t * pcb) {
+
+    if (getRunningTask(sim, cpu) != NULL) {
+
+        setState(pcb, READY);
+        appendPCB(getReadyQueue(sim, cpu), pcb);
+
+    } else {
+
+        runTask(sim, cpu, pcb);
+
+    }
 
 }
 
-void startTask(PCB_t * pcb) {
+/**
+ * @brief Dispatches the next task of a CPU, if there is any
+ */
+static void runNextTask(Simulator_t * sim, unsigned int cpu) {
 
-    // TODO: Complete the function
+    PCB_t * nextToRun = schedule(sim, cpu);
+
+    if (nextToRun != NULL) {
+
+        runTask(sim, cpu, nextToRun);
+
+    }
 
 }
 
-void exitTask(PCB_t * pcb) {
+static void startTask(Simulator_t * sim, unsigned int cpu, PCB_t * pcb) {
 
-    // TODO: Complete the function
+    readyTask(sim, cpu, pcb);
 
 }
 
-void clockTick(PCB_t * pcb) {
+static void exitTask(Simulator_t * sim, unsigned int cpu, PCB_t * pcb) {
 
-    PCB_t * nextToRun = NULL;
+    // Set the exit task to finished state
+    setState(pcb, FINISHED);
 
-    // Check if there is a task currently running on the CPU
-    if (pcb != NULL) {
+    // A task that finishes on a device leaves its CPU alone
+    if (getRunningTask(sim, cpu) != NULL) {
 
-        // If there is a task currently running, its timeslice must be updated
-        unsigned int timeslice = getTimeslice(pcb);
+        return;
 
-        timeslice = timeslice - 1;
+    }
 
-        setTimeslice(pcb, timeslice);
+    runNextTask(sim, cpu);
 
-        // Check if its quantum has expired
-        if (timeslice == 0) {
+}
 
-            // If its quantum has expired, put the task to ready state and
-            // append it to the end of the ready queue
-            setState(pcb, READY);
-            appendPCB(readyQueue, pcb);
+static void clockTick(Simulator_t * sim, unsigned int cpu, PCB_t * pcb) {
 
-            // Check if there is a candidate for running on the CPU
-            nextToRun = schedule();
+    // Check if there is a task currently running on the CPU and if its
+    // quantum has expired
+    if (pcb == NULL ||
+        getClock(sim) - getDispatchTime(sim, cpu) < getTimeslice(pcb)) {
 
-            if (nextToRun != NULL) {
+        return;
 
-                // If there is a candidate, then set it to running state,
-                // initialize its timeslice and dispatch it to the CPU
-                setState(nextToRun, RUNNING);
-                setTimeslice(nextToRun, TIMESLICE);
+    }
+
+    // If its quantum has expired, put the task to ready state and append it
+    // to the end of the ready queue. If it is the only candidate, it runs
+    // again with a new quantum
+    setState(pcb, READY);
+    appendPCB(getReadyQueue(sim, cpu), pcb);
 
-                dispatch(nextToRun);
+    runNextTask(sim, cpu);
 
-            }
+}
 
-        }
+static unsigned int nextClockEvent(Simulator_t * sim, unsigned int cpu,
+                                   PCB_t * pcb) {
+
+    // The running task is preempted when its timeslice expires
+    if (pcb != NULL) {
+
+        return getTimeslice(pcb) - (getClock(sim) - getDispatchTime(sim, cpu));
 
     }
 
-    return;
+    return UINT_MAX;
 
 }
 
-void yieldHardDisk(PCB_t * pcb) {
+static void yieldDevice(Simulator_t * sim, unsigned int cpu,
+                        unsigned int device, PCB_t * pcb) {
 
-    // TODO: Complete the function
+    // Set the task to waiting state. The simulator hands it to the device
+    setState(pcb, WAITING);
+
+    // Since the task has abandoned the CPU, we need to select another one to
+    // run
+    runNextTask(sim, cpu);
 
 }
 
-void ioHardDiskIRQ(PCB_t * pcb) {
+static void ioDeviceIRQ(Simulator_t * sim, unsigned int cpu,
+                        unsigned int device, PCB_t * pcb) {
 
-    // TODO: Complete the function
+    // The task gets a new quantum when it runs again
+    readyTask(sim, cpu, pcb);
 
 }
 
-void yieldKeyboard(PCB_t * pcb) {
+static void migrateTask(Simulator_t * sim, unsigned int cpu, PCB_t * pcb) {
 
-    // TODO: Complete the function
+    // The task is already in ready state. If the new CPU is idle, it runs
+    // the task straight away; otherwise the task waits on its ready queue
+    readyTask(sim, cpu, pcb);
 
 }
 
-void ioKeyboardIRQ(PCB_t * pcb) {
+const SchedPolicy_t rrPolicy = {
 
-    // TODO: Complete the function
+    .name = "rr",
 
-}
+    .schedule = schedule,
+    .startTask = startTask,
+    .exitTask = exitTask,
+    .clockTick = clockTick,
+    .nextClockEvent = nextClockEvent,
+    .yieldDevice = yieldDevice,
+    .ioDeviceIRQ = ioDeviceIRQ,
+    .migrateTask = migrateTask
+
+};
@@ -0,0 +1,249 @@
+#include <stdio.h>
+#include <limits.h>
+
+#include <os.h>
+#include <sched.h>
+
+/**
+ * Fixed point scale of the predicted bursts of the sjf-exp policy, so that
+ * the exponential average does not lose the fractions of a tick.
+ */
+#define PREDICTION_SCALE 1024ULL
+
+/*
+ * Shortest job first policies. The ready queues are ordered by the key of
+ * the PCBs, which is the length of the next CPU burst of the task:
+ *
+ * - sjf: the exact remaining time of the burst, and a task keeps the CPU
+ *   until the burst ends.
+ * - srtf: the same key, but a task that becomes ready with a shorter
+ *   remaining time than the running one preempts it.
+ * - sjf-exp: a prediction of the length of the burst, the exponential
+ *   average of the previous bursts of the task with a weight of 1/2. The
+ *   first prediction is the quantum of the task. A task keeps the CPU until
+ *   the burst ends.
+ *
+ * sjf and srtf know the future, so they are lower bounds of the waiting
+ * times that a real scheduler can achieve.
+ */
+
+static PCB_t * schedule(Simulator_t * sim, unsigned int cpu) {
+
+    // The first element of the ready queue is the shortest job
+    return extractFirst(getReadyQueue(sim, cpu));
+
+}
+
+static void runTask(Simulator_t * sim, unsigned int cpu, PCB_t * pcb) {
+
+    setState(pcb, RUNNING);
+    dispatch(sim, cpu, pcb);
+
+}
+
+/**
+ * @brief Dispatches the next task of a CPU, if there is any
+ */
+static void runNextTask(Simulator_t * sim, unsigned int cpu) {
+
+    PCB_t * nextToRun = schedule(sim, cpu);
+
+    if (nextToRun != NULL) {
+
+        runTask(sim, cpu, nextToRun);
+
+    }
+
+}
+
+/**
+ * @brief Makes a task ready to run on a CPU, without preempting it
+ */
+static void queueTask(Simulator_t * sim, unsigned int cpu, PCB_t * pcb) {
+
+    if (getRunningTask(sim, cpu) != NULL) {
+
+        setState(pcb, READY);
+        addPCBByKey(getReadyQueue(sim, cpu), pcb);
+
+    } else {
+
+        runTask(sim, cpu, pcb);
+
+    }
+
+}
+
+/**
+ * @brief Makes a task ready with its remaining burst time as its key
+ */
+static void readyShortest(Simulator_t * sim, unsigned int cpu, PCB_t * pcb) {
+
+    setKey(pcb, getBurstRemaining(sim, pcb));
+
+    queueTask(sim, cpu, pcb);
+
+}
+
+/**
+ * @brief Makes a task ready, preempting the running task if its remaining
+ * burst time is longer
+ */
+static void readyShortestRemaining(Simulator_t * sim, unsigned int cpu,
+                                   PCB_t * pcb) {
+
+    PCB_t * runningTask = getRunningTask(sim, cpu);
+
+    setKey(pcb, getBurstRemaining(sim, pcb));
+
+    if (runningTask != NULL &&
+        getKey(pcb) < getBurstRemaining(sim, runningTask)) {
+
+        // The preempted task goes back to the ready queue
+        setKey(runningTask, getBurstRemaining(sim, runningTask));
+
+        setState(runningTask, READY);
+        addPCBByKey(getReadyQueue(sim, cpu), runningTask);
+
+        runTask(sim, cpu, pcb);
+
+    } else {
+
+        queueTask(sim, cpu, pcb);
+
+    }
+
+}
+
+/**
+ * @brief Makes a new task ready with the first prediction of its bursts
+ */
+static void startPredicted(Simulator_t * sim, unsigned int cpu, PCB_t * pcb) {
+
+    setKey(pcb, getTaskQuantum(sim, pcb) * PREDICTION_SCALE);
+
+    queueTask(sim, cpu, pcb);
+
+}
+
+static void exitTask(Simulator_t * sim, unsigned int cpu, PCB_t * pcb) {
+
+    // Set the exit task to finished state
+    setState(pcb, FINISHED);
+
+    // A task that finishes on a device leaves its CPU alone
+    if (getRunningTask(sim, cpu) != NULL) {
+
+        return;
+
+    }
+
+    runNextTask(sim, cpu);
+
+}
+
+static void clockTick(Simulator_t * sim, unsigned int cpu, PCB_t * pcb) {
+
+    // Tasks are only preempted when another task becomes ready
+    return;
+
+}
+
+static unsigned int nextClockEvent(Simulator_t * sim, unsigned int cpu,
+                                   PCB_t * pcb) {
+
+    // The clock tick never triggers anything
+    return UINT_MAX;
+
+}
+
+static void yieldDevice(Simulator_t * sim, unsigned int cpu,
+                        unsigned int device, PCB_t * pcb) {
+
+    // Set the task to waiting state. The simulator hands it to the device
+    setState(pcb, WAITING);
+
+    // Since the task has abandoned the CPU, we need to select another one to
+    // run
+    runNextTask(sim, cpu);
+
+}
+
+static void yieldPredicted(Simulator_t * sim, unsigned int cpu,
+                           unsigned int device, PCB_t * pcb) {
+
+    // The task has run its whole burst since it was dispatched, which
+    // updates the prediction of the next one
+    unsigned long long burst = getClock(sim) - getDispatchTime(sim, cpu);
+
+    setKey(pcb, (burst * PREDICTION_SCALE + getKey(pcb)) / 2);
+
+    yieldDevice(sim, cpu, device, pcb);
+
+}
+
+static void ioDeviceShortest(Simulator_t * sim, unsigned int cpu,
+                             unsigned int device, PCB_t * pcb) {
+
+    readyShortest(sim, cpu, pcb);
+
+}
+
+static void ioDeviceShortestRemaining(Simulator_t * sim, unsigned int cpu,
+                                      unsigned int device, PCB_t * pcb) {
+
+    readyShortestRemaining(sim, cpu, pcb);
+
+}
+
+static void ioDevicePredicted(Simulator_t * sim, unsigned int cpu,
+                              unsigned int device, PCB_t * pcb) {
+
+    queueTask(sim, cpu, pcb);
+
+}
+
+const SchedPolicy_t sjfPolicy = {
+
+    .name = "sjf",
+
+    .schedule = schedule,
+    .startTask = readyShortest,
+    .exitTask = exitTask,
+    .clockTick = clockTick,
+    .nextClockEvent = nextClockEvent,
+    .yieldDevice = yieldDevice,
+    .ioDeviceIRQ = ioDeviceShortest,
+    .migrateTask = readyShortest
+
+};
+
+const SchedPolicy_t srtfPolicy = {
+
+    .name = "srtf",
+
+    .schedule = schedule,
+    .startTask = readyShortestRemaining,
+    .exitTask = exitTask,
+    .clockTick = clockTick,
+    .nextClockEvent = nextClockEvent,
+    .yieldDevice = yieldDevice,
+    .ioDeviceIRQ = ioDeviceShortestRemaining,
+    .migrateTask = readyShortestRemaining
+
+};
+
+const SchedPolicy_t sjfExpPolicy = {
+
+    .name = "sjf-exp",
+
+    .schedule = schedule,
+    .startTask = startPredicted,
+    .exitTask = exitTask,
+    .clockTick = clockTick,
+    .nextClockEvent = nextClockEvent,
+    .yieldDevice = yieldPredicted,
+    .ioDeviceIRQ = ioDevicePredicted,
+    .migrateTask = queueTask
+
+};
@@ -0,0 +1,301 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+#include <schedsim.h>
+#include <simulator.h>
+#include <parser.h>
+#include <workload.h>
+
+struct schedsim {
+
+    SimOptions_t options;
+
+    TaskDescriptorList_t list;
+
+    /** Simulations of a handle are never traced */
+    Trace_t trace;
+
+    Simulator_t sim;
+
+};
+
+Schedsim_t * schedsimCreate() {
+
+    Schedsim_t * handle = (Schedsim_t *)malloc(sizeof(Schedsim_t));
+
+    if (handle == NULL) {
+
+        perror("Not enough memory for the simulation");
+        return NULL;
+
+    }
+
+    initSimOptions(&(handle->options));
+
+    initTaskDescriptorList(&(handle->list));
+
+    openTrace(&(handle->trace), TRACE_OFF, 1, -1);
+
+    if (initSimulator(&(handle->sim), &(handle->options),
+                      &(handle->trace)) != 0) {
+
+        schedsimDestroy(handle);
+
+        return NULL;
+
+    }
+
+    return handle;
+
+}
+
+Schedsim_t * schedsimClone(const Schedsim_t * handle) {
+
+    Schedsim_t * copy = schedsimCreate();
+
+    if (copy == NULL) {
+
+        return NULL;
+
+    }
+
+    copy->options = handle->options;
+
+    if (cloneDescriptors(&(copy->list), &(handle->list)) != 0) {
+
+        schedsimDestroy(copy);
+
+        return NULL;
+
+    }
+
+    return copy;
+
+}
+
+void schedsimDestroy(Schedsim_t * handle) {
+
+    freeSimulator(&(handle->sim));
+
+    closeTrace(&(handle->trace));
+
+    freeDescriptors(&(handle->list));
+
+    free(handle);
+
+}
+
+int schedsimLoadFile(Schedsim_t * handle, const char * path) {
+
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0) {
+
+        return -1;
+
+    }
+
+    freeDescriptors(&(handle->list));
+
+    initTaskDescriptorList(&(handle->list));
+
+    // Handles may be used from several threads, so the parse stays on the
+    // calling one
+    if (readDescriptors(&(handle->list), fd, 1) != 0) {
+
+        // Do not keep half a workload
+        freeDescriptors(&(handle->list));
+
+        initTaskDescriptorList(&(handle->list));
+
+        close(fd);
+
+        return -1;
+
+    }
+
+    close(fd);
+
+    return 0;
+
+}
+
+int schedsimSetPolicy(Schedsim_t * handle, const char * name) {
+
+    const SchedPolicy_t * policy = findPolicy(name);
+
+    if (policy == NULL) {
+
+        return -1;
+
+    }
+
+    handle->options.policy = policy;
+
+    return 0;
+
+}
+
+int schedsimSetEngine(Schedsim_t * handle, const char * name) {
+
+    if (strcmp(name, "tick") == 0) {
+
+        handle->options.engine = TICK_ENGINE;
+
+    } else if (strcmp(name, "event") == 0) {
+
+        handle->options.engine = EVENT_ENGINE;
+
+    } else if (strcmp(name, "parallel") == 0) {
+
+        handle->options.engine = PARALLEL_ENGINE;
+
+    } else {
+
+        return -1;
+
+    }
+
+    return 0;
+
+}
+
+int schedsimSetQuantum(Schedsim_t * handle, unsigned int quantum) {
+
+    if (quantum == 0) {
+
+        return -1;
+
+    }
+
+    handle->options.quantum = quantum;
+
+    return 0;
+
+}
+
+int schedsimSetAging(Schedsim_t * handle, unsigned int aging) {
+
+    handle->options.aging = aging;
+
+    return 0;
+
+}
+
+int schedsimSetLevels(Schedsim_t * handle, unsigned int levels) {
+
+    if (levels == 0 || levels > MAX_LEVELS) {
+
+        return -1;
+
+    }
+
+    handle->options.levels = levels;
+
+    return 0;
+
+}
+
+int schedsimSetBoost(Schedsim_t * handle, unsigned int boost) {
+
+    handle->options.boost = boost;
+
+    return 0;
+
+}
+
+int schedsimSetCpus(Schedsim_t * handle, unsigned int cpus) {
+
+    if (cpus == 0 || cpus > MAX_CPUS || cpus % handle->options.partitions != 0) {
+
+        return -1;
+
+    }
+
+    handle->options.cpus = cpus;
+
+    return 0;
+
+}
+
+int schedsimSetPartitions(Schedsim_t * handle, unsigned int partitions,
+                          unsigned int threads) {
+
+    if (partitions == 0 || threads == 0 ||
+        handle->options.cpus % partitions != 0) {
+
+        return -1;
+
+    }
+
+    handle->options.partitions = partitions;
+    handle->options.threads = threads;
+
+    return 0;
+
+}
+
+int schedsimSetBalancer(Schedsim_t * handle, const char * name) {
+
+    if (strcmp(name, "none") == 0) {
+
+        handle->options.balancer = BALANCE_NONE;
+
+    } else if (strcmp(name, "push") == 0) {
+
+        handle->options.balancer = BALANCE_PUSH;
+
+    } else if (strcmp(name, "steal") == 0) {
+
+        handle->options.balancer = BALANCE_STEAL;
+
+    } else {
+
+        return -1;
+
+    }
+
+    return 0;
+
+}
+
+int schedsimRun(Schedsim_t * handle) {
+
+    resetDescriptors(&(handle->list));
+
+    freeSimulator(&(handle->sim));
+
+    if (initSimulator(&(handle->sim), &(handle->options),
+                      &(handle->trace)) != 0) {
+
+        return -1;
+
+    }
+
+    return runOS(&(handle->sim), &(handle->list));
+
+}
+
+unsigned int schedsimGetTicks(const Schedsim_t * handle) {
+
+    return handle->sim.clock;
+
+}
+
+unsigned int schedsimGetUnfinished(const Schedsim_t * handle) {
+
+    return handle->sim.livingTasks;
+
+}
+
+int schedsimGetMetrics(Schedsim_t * handle, MetricsSummary_t * summary) {
+
+    return summarizeMetrics(&(handle->sim.metrics), summary);
+
+}
@@ -0,0 +1,35 @@
+#include <stdio.h>
+
+#include <source.h>
+
+static TaskDescriptor_t * nextFromList(TaskSource_t * source) {
+
+    ListSource_t * listSource = (ListSource_t *)source;
+    TaskDescriptor_t * desc = listSource->cursor;
+
+    if (desc != NULL) {
+
+        listSource->cursor = desc->next;
+
+    }
+
+    return desc;
+
+}
+
+static void releaseToList(TaskSource_t * source, TaskDescriptor_t * desc) {
+
+    // The descriptors belong to the list
+    return;
+
+}
+
+void openListSource(ListSource_t * listSource, TaskDescriptorList_t * list) {
+
+    listSource->source.next = nextFromList;
+    listSource->source.release = releaseToList;
+    listSource->source.devices = &(list->devices);
+
+    listSource->cursor = list->first;
+
+}
@@ -0,0 +1,466 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <ctype.h>
+#include <pthread.h>
+
+#include <sweep.h>
+#include <parser.h>
+
+/**
+ * Result of a single simulation of the sweep.
+ */
+typedef struct {
+
+    unsigned int ticks;
+    unsigned int tasks;
+    unsigned int unfinished;
+    MetricsSummary_t summary;
+
+} SweepResult_t;
+
+/**
+ * State shared by all the threads of a sweep.
+ */
+typedef struct {
+
+    const TaskDescriptorList_t * list;
+    const SimOptions_t * base;
+    const SchedPolicy_t * const * policies;
+    const SweepRange_t * range;
+
+    unsigned int values;
+    unsigned int jobs;
+
+    /** Next simulation to run, protected by the lock */
+    unsigned int nextJob;
+    pthread_mutex_t lock;
+
+    /** Non-zero if any simulation has failed, protected by the lock */
+    int failed;
+
+    SweepResult_t * results;
+
+} Sweep_t;
+
+static void setQuantum(SimOptions_t * options, unsigned int value) {
+
+    options->quantum = value;
+
+}
+
+static void setAging(SimOptions_t * options, unsigned int value) {
+
+    options->aging = value;
+
+}
+
+static void setLevels(SimOptions_t * options, unsigned int value) {
+
+    options->levels = value;
+
+}
+
+static void setBoost(SimOptions_t * options, unsigned int value) {
+
+    options->boost = value;
+
+}
+
+static void setCpus(SimOptions_t * options, unsigned int value) {
+
+    options->cpus = value;
+
+}
+
+static const SweepKnob_t quantumKnob = {
+    .name = "quantum", .min = 1, .max = UINT_MAX, .set = setQuantum
+};
+
+static const SweepKnob_t agingKnob = {
+    .name = "aging", .min = 0, .max = UINT_MAX, .set = setAging
+};
+
+static const SweepKnob_t levelsKnob = {
+    .name = "levels", .min = 1, .max = MAX_LEVELS, .set = setLevels
+};
+
+static const SweepKnob_t boostKnob = {
+    .name = "boost", .min = 0, .max = UINT_MAX, .set = setBoost
+};
+
+static const SweepKnob_t cpusKnob = {
+    .name = "cpus", .min = 1, .max = MAX_CPUS, .set = setCpus
+};
+
+/** Knobs that can be swept */
+static const SweepKnob_t * const knobs[] = {
+    &quantumKnob,
+    &agingKnob,
+    &levelsKnob,
+    &boostKnob,
+    &cpusKnob,
+    NULL
+};
+
+const SweepKnob_t * const * getSweepKnobs() {
+
+    return knobs;
+
+}
+
+/**
+ * @brief Parses one bound of a sweep range
+ *
+ * @param spec text of the bound
+ * @param end set to the first character after the bound
+ * @param value set to the parsed bound
+ * @return 0 on success, -1 if the bound is missing or does not fit an
+ * unsigned int
+ */
+static int parseBound(const char * spec, char ** end, unsigned int * value) {
+
+    unsigned long parsed = 0;
+
+    /* strtoul silently negates a leading minus sign */
+    if (!isdigit((unsigned char)*spec)) {
+
+        return -1;
+
+    }
+
+    errno = 0;
+    parsed = strtoul(spec, end, 10);
+
+    if (errno == ERANGE || parsed > UINT_MAX) {
+
+        return -1;
+
+    }
+
+    *value = (unsigned int)parsed;
+
+    return 0;
+
+}
+
+int parseSweepRange(SweepRange_t * range, const char * spec) {
+
+    const char * separator = strchr(spec, '=');
+    char * end = NULL;
+    int i = 0;
+
+    if (separator == NULL) {
+
+        return -1;
+
+    }
+
+    range->knob = NULL;
+
+    for (i = 0; knobs[i] != NULL; i++) {
+
+        if (strlen(knobs[i]->name) == (size_t)(separator - spec) &&
+            strncmp(knobs[i]->name, spec, separator - spec) == 0) {
+
+            range->knob = knobs[i];
+
+        }
+
+    }
+
+    if (range->knob == NULL) {
+
+        return -1;
+
+    }
+
+    if (parseBound(separator + 1, &end, &range->from) != 0 || *end != ':') {
+
+        return -1;
+
+    }
+
+    spec = end + 1;
+    if (parseBound(spec, &end, &range->to) != 0 ||
+        (*end != ':' && *end != '\0')) {
+
+        return -1;
+
+    }
+
+    range->step = 1;
+
+    if (*end == ':') {
+
+        spec = end + 1;
+        if (parseBound(spec, &end, &range->step) != 0 || *end != '\0') {
+
+            return -1;
+
+        }
+
+    }
+
+    if (range->step == 0 || range->from > range->to ||
+        range->from < range->knob->min || range->to > range->knob->max) {
+
+        return -1;
+
+    }
+
+    return 0;
+
+}
+
+/**
+ * @brief Takes the next simulation of the sweep
+ *
+ * @return Index of the simulation or -1 if there are no simulations left
+ * or the sweep has failed.
+ */
+static int takeJob(Sweep_t * sweep) {
+
+    int job = -1;
+
+    pthread_mutex_lock(&(sweep->lock));
+
+    // Once a simulation has failed, the sweep is given up
+    if (!sweep->failed && sweep->nextJob < sweep->jobs) {
+
+        job = sweep->nextJob;
+        sweep->nextJob = sweep->nextJob + 1;
+
+    }
+
+    pthread_mutex_unlock(&(sweep->lock));
+
+    return job;
+
+}
+
+/**
+ * @brief Marks the sweep as failed
+ */
+static void failSweep(Sweep_t * sweep) {
+
+    pthread_mutex_lock(&(sweep->lock));
+
+    sweep->failed = 1;
+
+    pthread_mutex_unlock(&(sweep->lock));
+
+}
+
+/**
+ * @brief Body of the threads of the pool
+ *
+ * Every thread copies the workload once and simulates it again and again,
+ * resetting it before every simulation. A thread that cannot copy the
+ * workload leaves its simulations to the other threads.
+ */
+static void * sweepWorker(void * arg) {
+
+    Sweep_t * sweep = (Sweep_t *)arg;
+    TaskDescriptorList_t list;
+    SimOptions_t options;
+    Simulator_t sim;
+    Trace_t trace;
+    SweepResult_t * result = NULL;
+    int job = 0;
+
+    if (cloneDescriptors(&list, sweep->list) != 0) {
+
+        failSweep(sweep);
+        return NULL;
+
+    }
+
+    openTrace(&trace, TRACE_OFF, 1, -1);
+
+    while ((job = takeJob(sweep)) >= 0) {
+
+        options = *(sweep->base);
+        options.policy = sweep->policies[job / sweep->values];
+
+        sweep->range->knob->set(&options, sweep->range->from +
+                                (job % sweep->values) * sweep->range->step);
+
+        resetDescriptors(&list);
+
+        result = &(sweep->results[job]);
+
+        if (initSimulator(&sim, &options, &trace) != 0 ||
+            runOS(&sim, &list) != 0 ||
+            summarizeMetrics(&(sim.metrics), &(result->summary)) != 0) {
+
+            failSweep(sweep);
+
+        }
+
+        result->ticks = sim.clock;
+        result->tasks = sim.nextPID;
+        result->unfinished = sim.livingTasks;
+
+        freeSimulator(&sim);
+
+    }
+
+    closeTrace(&trace);
+
+    freeDescriptors(&list);
+
+    return NULL;
+
+}
+
+/**
+ * @brief Prints the results of the sweep as CSV
+ */
+static void printSweep(Sweep_t * sweep, Trace_t * output) {
+
+    SweepResult_t * result = NULL;
+    MetricStats_t * stats = NULL;
+    unsigned int job = 0;
+    int metric = 0;
+
+    tracePrintf(output, "policy,%s,ticks,tasks,unfinished",
+                sweep->range->knob->name);
+
+    for (metric = 0; metric < METRICS; metric++) {
+
+        tracePrintf(output, ",%s_mean,%s_p50,%s_p95,%s_p99,%s_max",
+                    getMetricKey(metric), getMetricKey(metric),
+                    getMetricKey(metric), getMetricKey(metric),
+                    getMetricKey(metric));
+
+    }
+
+    tracePrintf(output, "\n");
+
+    for (job = 0; job < sweep->jobs; job++) {
+
+        result = &(sweep->results[job]);
+
+        tracePrintf(output, "%s,%u,%u,%u,%u",
+                    sweep->policies[job / sweep->values]->name,
+                    sweep->range->from + (job % sweep->values) * sweep->range->step,
+                    result->ticks, result->tasks, result->unfinished);
+
+        for (metric = 0; metric < METRICS; metric++) {
+
+            stats = &(result->summary.stats[metric]);
+
+            tracePrintf(output, ",%.2f,%u,%u,%u,%u", stats->mean, stats->p50,
+                        stats->p95, stats->p99, stats->max);
+
+        }
+
+        tracePrintf(output, "\n");
+
+    }
+
+}
+
+int runSweep(const TaskDescriptorList_t * list, const SimOptions_t * base,
+             const SchedPolicy_t * const * policies,
+             const SweepRange_t * range, unsigned int threads,
+             Trace_t * output) {
+
+    Sweep_t sweep;
+    pthread_t * pool = NULL;
+    unsigned long long values = 0;
+    unsigned int policyCount = 0;
+    unsigned int i = 0;
+
+    for (policyCount = 0; policies[policyCount] != NULL; policyCount++);
+
+    // A full range has 2^32 values, one more than an unsigned int holds
+    values = ((unsigned long long)range->to - range->from) / range->step + 1;
+
+    // The simulations are numbered by takeJob with an int
+    if (values * policyCount > INT_MAX) {
+
+        fprintf(stderr, "Too many simulations in the sweep\n");
+        return -1;
+
+    }
+
+    sweep.list = list;
+    sweep.base = base;
+    sweep.policies = policies;
+    sweep.range = range;
+    sweep.values = (unsigned int)values;
+    sweep.jobs = policyCount * sweep.values;
+    sweep.nextJob = 0;
+    sweep.failed = 0;
+
+    if (threads > sweep.jobs) {
+
+        threads = sweep.jobs;
+
+    }
+
+    sweep.results = (SweepResult_t *)calloc(sweep.jobs, sizeof(SweepResult_t));
+    pool = (pthread_t *)malloc(threads * sizeof(pthread_t));
+
+    if (sweep.results == NULL || pool == NULL) {
+
+        perror("Not enough memory for the sweep");
+        free(sweep.results);
+        free(pool);
+        return -1;
+
+    }
+
+    pthread_mutex_init(&(sweep.lock), NULL);
+
+    for (i = 0; i < threads; i++) {
+
+        if (pthread_create(&pool[i], NULL, sweepWorker, &sweep) != 0) {
+
+            break;
+
+        }
+
+    }
+
+    // If no thread could be started, the simulations run on this one
+    if (i == 0) {
+
+        sweepWorker(&sweep);
+
+    }
+
+    threads = i;
+
+    for (i = 0; i < threads; i++) {
+
+        pthread_join(pool[i], NULL);
+
+    }
+
+    // All the threads may have failed to copy the workload, leaving
+    // simulations behind
+    if (sweep.nextJob < sweep.jobs) {
+
+        sweep.failed = 1;
+
+    }
+
+    if (!sweep.failed) {
+
+        printSweep(&sweep, output);
+
+    }
+
+    pthread_mutex_destroy(&(sweep.lock));
+
+    free(pool);
+    free(sweep.results);
+
+    return sweep.failed ? -1 : 0;
+
+}
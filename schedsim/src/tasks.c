@@ -1,7 +1,425 @@
 #include <stdio.h>
+#include <string.h>
 
 #include <tasks.h>
 
+/** Function notified of every state transition */
+static StateListener_t stateListener;
+
+#ifdef BUCKET_QUEUES
+
+/** Number of bits of every word of the bucket bitmap */
+#define BITS_PER_WORD (8 * sizeof(unsigned long))
+
+/**
+ * @brief Returns the priority bucket of a PCB.
+ */
+static unsigned int bucketOf(PCB_t * pcb) {
+
+    return pcb->priority < QUEUE_BUCKETS ? pcb->priority : QUEUE_BUCKETS - 1;
+
+}
+
+/**
+ * @brief Marks a bucket as non-empty and sets its last PCB.
+ */
+static void setBucketLast(TaskQueue_t * queue, unsigned int bucket,
+                          PCB_t * pcb) {
+
+    queue->bucketLast[bucket] = pcb;
+    queue->bitmap[bucket / BITS_PER_WORD] |= 1UL << (bucket % BITS_PER_WORD);
+
+}
+
+/**
+ * @brief Marks a bucket as empty.
+ */
+static void clearBucket(TaskQueue_t * queue, unsigned int bucket) {
+
+    queue->bucketLast[bucket] = NULL;
+    queue->bitmap[bucket / BITS_PER_WORD] &= ~(1UL << (bucket % BITS_PER_WORD));
+
+}
+
+/**
+ * @brief Finds the lowest non-empty bucket greater than or equal to a given
+ * one.
+ *
+ * @return The index of the bucket or QUEUE_BUCKETS if there is none.
+ */
+static unsigned int findNextBucket(TaskQueue_t * queue, unsigned int bucket) {
+
+    unsigned int word = bucket / BITS_PER_WORD;
+    unsigned long bits = queue->bitmap[word] & (~0UL << (bucket % BITS_PER_WORD));
+
+    while (bits == 0) {
+
+        word = word + 1;
+
+        if (word == QUEUE_BITMAP_WORDS) {
+
+            return QUEUE_BUCKETS;
+
+        }
+
+        bits = queue->bitmap[word];
+
+    }
+
+    return word * BITS_PER_WORD + __builtin_ctzl(bits);
+
+}
+
+#endif
+
+/**
+ * @brief Links a PCB in a queue right after a given element.
+ *
+ * @param queue Pointer to the queue.
+ * @param prevElement Element after which the PCB is linked or NULL to link
+ * it at the beginning of the queue.
+ * @param pcb Pointer to the PCB to link.
+ */
+static void linkAfter(TaskQueue_t * queue, PCB_t * prevElement, PCB_t * pcb) {
+
+    PCB_t * nextElement = prevElement != NULL ? prevElement->next : queue->first;
+
+    pcb->prev = prevElement;
+    pcb->next = nextElement;
+
+    if (prevElement != NULL) {
+
+        prevElement->next = pcb;
+
+    } else {
+
+        queue->first = pcb;
+
+    }
+
+    if (nextElement != NULL) {
+
+        nextElement->prev = pcb;
+
+    } else {
+
+        queue->last = pcb;
+
+    }
+
+    queue->size = queue->size + 1;
+
+}
+
+/**
+ * @brief Checks whether a node of a red-black tree is red.
+ *
+ * The NULL leaves are black.
+ */
+static int isRed(PCB_t * node) {
+
+    return node != NULL && node->red;
+
+}
+
+/**
+ * @brief Replaces a node of a red-black tree by another one in its parent.
+ */
+static void replaceChild(TaskQueue_t * queue, PCB_t * node, PCB_t * child) {
+
+    if (node->parent == NULL) {
+
+        queue->root = child;
+
+    } else if (node == node->parent->left) {
+
+        node->parent->left = child;
+
+    } else {
+
+        node->parent->right = child;
+
+    }
+
+    if (child != NULL) {
+
+        child->parent = node->parent;
+
+    }
+
+}
+
+static void rotateLeft(TaskQueue_t * queue, PCB_t * node) {
+
+    PCB_t * right = node->right;
+
+    node->right = right->left;
+
+    if (right->left != NULL) {
+
+        right->left->parent = node;
+
+    }
+
+    replaceChild(queue, node, right);
+
+    right->left = node;
+    node->parent = right;
+
+}
+
+static void rotateRight(TaskQueue_t * queue, PCB_t * node) {
+
+    PCB_t * left = node->left;
+
+    node->left = left->right;
+
+    if (left->right != NULL) {
+
+        left->right->parent = node;
+
+    }
+
+    replaceChild(queue, node, left);
+
+    left->right = node;
+    node->parent = left;
+
+}
+
+/**
+ * @brief Restores the red-black properties after inserting a red node.
+ */
+static void fixInsertion(TaskQueue_t * queue, PCB_t * node) {
+
+    PCB_t * parent = NULL, * grandparent = NULL, * uncle = NULL;
+
+    while (isRed(node->parent)) {
+
+        // A red parent is never the root, so the grandparent exists
+        parent = node->parent;
+        grandparent = parent->parent;
+
+        if (parent == grandparent->left) {
+
+            uncle = grandparent->right;
+
+            if (isRed(uncle)) {
+
+                parent->red = uncle->red = 0;
+                grandparent->red = 1;
+                node = grandparent;
+
+            } else {
+
+                if (node == parent->right) {
+
+                    rotateLeft(queue, parent);
+                    node = parent;
+                    parent = node->parent;
+
+                }
+
+                parent->red = 0;
+                grandparent->red = 1;
+                rotateRight(queue, grandparent);
+
+            }
+
+        } else {
+
+            uncle = grandparent->left;
+
+            if (isRed(uncle)) {
+
+                parent->red = uncle->red = 0;
+                grandparent->red = 1;
+                node = grandparent;
+
+            } else {
+
+                if (node == parent->left) {
+
+                    rotateRight(queue, parent);
+                    node = parent;
+                    parent = node->parent;
+
+                }
+
+                parent->red = 0;
+                grandparent->red = 1;
+                rotateLeft(queue, grandparent);
+
+            }
+
+        }
+
+    }
+
+    queue->root->red = 0;
+
+}
+
+/**
+ * @brief Restores the red-black properties after removing a black node.
+ *
+ * @param queue Pointer to the queue.
+ * @param node Node that took the place of the removed one, which may be a
+ * NULL leaf.
+ * @param parent Parent of that node.
+ */
+static void fixRemoval(TaskQueue_t * queue, PCB_t * node, PCB_t * parent) {
+
+    PCB_t * sibling = NULL;
+
+    while (node != queue->root && !isRed(node)) {
+
+        if (node == parent->left) {
+
+            sibling = parent->right;
+
+            if (isRed(sibling)) {
+
+                sibling->red = 0;
+                parent->red = 1;
+                rotateLeft(queue, parent);
+                sibling = parent->right;
+
+            }
+
+            if (!isRed(sibling->left) && !isRed(sibling->right)) {
+
+                sibling->red = 1;
+                node = parent;
+                parent = node->parent;
+
+            } else {
+
+                if (!isRed(sibling->right)) {
+
+                    sibling->left->red = 0;
+                    sibling->red = 1;
+                    rotateRight(queue, sibling);
+                    sibling = parent->right;
+
+                }
+
+                sibling->red = parent->red;
+                parent->red = 0;
+                sibling->right->red = 0;
+                rotateLeft(queue, parent);
+                node = queue->root;
+
+            }
+
+        } else {
+
+            sibling = parent->left;
+
+            if (isRed(sibling)) {
+
+                sibling->red = 0;
+                parent->red = 1;
+                rotateRight(queue, parent);
+                sibling = parent->left;
+
+            }
+
+            if (!isRed(sibling->left) && !isRed(sibling->right)) {
+
+                sibling->red = 1;
+                node = parent;
+                parent = node->parent;
+
+            } else {
+
+                if (!isRed(sibling->left)) {
+
+                    sibling->right->red = 0;
+                    sibling->red = 1;
+                    rotateLeft(queue, sibling);
+                    sibling = parent->left;
+
+                }
+
+                sibling->red = parent->red;
+                parent->red = 0;
+                sibling->left->red = 0;
+                rotateRight(queue, parent);
+                node = queue->root;
+
+            }
+
+        }
+
+    }
+
+    if (node != NULL) {
+
+        node->red = 0;
+
+    }
+
+}
+
+/**
+ * @brief Removes a PCB from the red-black tree of a queue ordered by key.
+ *
+ * The PCB stays linked in the queue.
+ */
+static void removeNode(TaskQueue_t * queue, PCB_t * pcb) {
+
+    PCB_t * successor = NULL, * child = NULL, * parent = NULL;
+    int removedRed = pcb->red;
+
+    if (pcb->left == NULL || pcb->right == NULL) {
+
+        child = pcb->left != NULL ? pcb->left : pcb->right;
+        parent = pcb->parent;
+
+        replaceChild(queue, pcb, child);
+
+    } else {
+
+        // The queue is in key order, so the next element is the successor
+        // of the PCB in the tree
+        successor = pcb->next;
+        removedRed = successor->red;
+        child = successor->right;
+
+        if (successor->parent == pcb) {
+
+            parent = successor;
+
+        } else {
+
+            parent = successor->parent;
+
+            replaceChild(queue, successor, child);
+
+            successor->right = pcb->right;
+            successor->right->parent = successor;
+
+        }
+
+        replaceChild(queue, pcb, successor);
+
+        successor->left = pcb->left;
+        successor->left->parent = successor;
+        successor->red = pcb->red;
+
+    }
+
+    if (!removedRed) {
+
+        fixRemoval(queue, child, parent);
+
+    }
+
+    pcb->parent = pcb->left = pcb->right = NULL;
+
+}
+
 void initPCB(PCB_t * pcb, unsigned int PID, char * command,
              unsigned int priority, unsigned int timeslice) {
 
@@ -10,10 +428,15 @@ void initPCB(PCB_t * pcb, unsigned int PID, char * command,
     pcb->command = command;
     pcb->priority = priority;
     pcb->timeslice = timeslice; 
+    pcb->cpu = 0;
+    pcb->key = 0;
     
     pcb->next = NULL;
     pcb->prev = NULL;
 
+    pcb->parent = pcb->left = pcb->right = NULL;
+    pcb->red = 0;
+
 }
 
 unsigned int getPriority(PCB_t * pcb) {
@@ -48,14 +471,46 @@ ProcessState_t getState(PCB_t * pcb) {
 
 void setState(PCB_t * pcb, ProcessState_t state) {
 
+    ProcessState_t previous = pcb->state;
+
     pcb->state = state;
 
+    if (stateListener != NULL) {
+
+        stateListener(pcb, previous, state);
+
+    }
+
+}
+
+void setStateListener(StateListener_t listener) {
+
+    stateListener = listener;
+
+}
+
+unsigned long long getKey(PCB_t * pcb) {
+
+    return pcb->key;
+
+}
+
+void setKey(PCB_t * pcb, unsigned long long key) {
+
+    pcb->key = key;
+
 }
 
 void initQueue(TaskQueue_t * queue) {
 
     queue->first = queue->last = NULL;
     queue->size = 0;
+    queue->root = NULL;
+
+#ifdef BUCKET_QUEUES
+    memset(queue->bitmap, 0, sizeof(queue->bitmap));
+    memset(queue->bucketLast, 0, sizeof(queue->bucketLast));
+#endif
 
 }
 
@@ -89,8 +544,67 @@ void appendPCB(TaskQueue_t * queue, PCB_t * pcb) {
 
     }
 
+#ifdef BUCKET_QUEUES
+    // The PCB is now the last one of its bucket
+    setBucketLast(queue, bucketOf(pcb), pcb);
+#endif
+
+}
+
+#ifdef BUCKET_QUEUES
+
+void addPCBByPriority(TaskQueue_t * queue, PCB_t * pcb) {
+
+    unsigned int bucket = bucketOf(pcb);
+    unsigned int nextBucket = 0;
+    PCB_t * prevElement = NULL;
+
+    if (bucket == QUEUE_BUCKETS - 1) {
+
+        // The last bucket holds every priority above QUEUE_BUCKETS - 2 and
+        // is always at the beginning of the queue, so the location must be
+        // found inside it
+        PCB_t * nextElement = queue->first;
+
+        while (nextElement != NULL && bucketOf(nextElement) == bucket &&
+               nextElement->priority >= pcb->priority) {
+
+            prevElement = nextElement;
+            nextElement = nextElement->next;
+
+        }
+
+        linkAfter(queue, prevElement, pcb);
+
+        if (nextElement == NULL || bucketOf(nextElement) != bucket) {
+
+            setBucketLast(queue, bucket, pcb);
+
+        }
+
+    } else {
+
+        // The new element goes right after the last element with the same
+        // or a greater priority, i.e. after the last element of the lowest
+        // non-empty bucket that is not below its own bucket
+        nextBucket = findNextBucket(queue, bucket);
+
+        if (nextBucket != QUEUE_BUCKETS) {
+
+            prevElement = queue->bucketLast[nextBucket];
+
+        }
+
+        linkAfter(queue, prevElement, pcb);
+
+        setBucketLast(queue, bucket, pcb);
+
+    }
+
 }
 
+#else
+
 void addPCBByPriority(TaskQueue_t * queue, PCB_t * pcb) {
 
     // If the queue is empty, then just add it
@@ -192,6 +706,100 @@ void addPCBByPriority(TaskQueue_t * queue, PCB_t * pcb) {
 
 }
 
+#endif
+
+void raisePriorities(TaskQueue_t * queue, unsigned int ceiling) {
+
+    PCB_t * pcb = NULL;
+#ifdef BUCKET_QUEUES
+    unsigned int bucket = 0;
+#endif
+
+    // The queue is in priority order, so the PCBs below the ceiling are at
+    // its end, and raising all of them by one keeps the order
+    for (pcb = queue->last; pcb != NULL && pcb->priority < ceiling;
+         pcb = pcb->prev) {
+
+        pcb->priority = pcb->priority + 1;
+
+    }
+
+#ifdef BUCKET_QUEUES
+    // Every bucket below the ceiling moves up by one. The PCBs that reach
+    // the ceiling go after the ones already there, so they end its bucket
+    if (queue->bucketLast[ceiling - 1] != NULL) {
+
+        setBucketLast(queue, ceiling, queue->bucketLast[ceiling - 1]);
+
+    }
+
+    for (bucket = ceiling - 1; bucket > 0; bucket--) {
+
+        if (queue->bucketLast[bucket - 1] != NULL) {
+
+            setBucketLast(queue, bucket, queue->bucketLast[bucket - 1]);
+
+        } else {
+
+            clearBucket(queue, bucket);
+
+        }
+
+    }
+
+    clearBucket(queue, 0);
+#endif
+
+}
+
+void addPCBByKey(TaskQueue_t * queue, PCB_t * pcb) {
+
+    PCB_t * node = queue->root, * parent = NULL, * prevElement = NULL;
+
+    // Walk down the tree to a leaf. PCBs with the same key go to the right,
+    // after the ones already queued. The last node where the walk turns
+    // right is the element that precedes the PCB in the queue
+    while (node != NULL) {
+
+        parent = node;
+
+        if (pcb->key < node->key) {
+
+            node = node->left;
+
+        } else {
+
+            prevElement = node;
+            node = node->right;
+
+        }
+
+    }
+
+    pcb->parent = parent;
+    pcb->left = pcb->right = NULL;
+    pcb->red = 1;
+
+    if (parent == NULL) {
+
+        queue->root = pcb;
+
+    } else if (pcb->key < parent->key) {
+
+        parent->left = pcb;
+
+    } else {
+
+        parent->right = pcb;
+
+    }
+
+    linkAfter(queue, prevElement, pcb);
+
+    fixInsertion(queue, pcb);
+
+}
+
 PCB_t * extractFirst(TaskQueue_t * queue) {
 
     PCB_t * first = queue->first;
@@ -202,7 +810,25 @@ PCB_t * extractFirst(TaskQueue_t * queue) {
 
         return NULL;
 
-    } else if (queue->size == 1) {
+    }
+
+    if (queue->root != NULL) {
+
+        removeNode(queue, first);
+
+    }
+
+#ifdef BUCKET_QUEUES
+    // If the first element was also the last one of its bucket, the bucket
+    // becomes empty
+    if (queue->bucketLast[bucketOf(first)] == first) {
+
+        clearBucket(queue, bucketOf(first));
+
+    }
+#endif
+
+    if (queue->size == 1) {
 
         queue->first = queue->last = NULL;
         queue->size = 0;
@@ -239,7 +865,43 @@ PCB_t * extractLast(TaskQueue_t * queue) {
 
         return NULL;
 
-    } else if (queue->size == 1) {
+    }
+
+    if (queue->root != NULL) {
+
+        removeNode(queue, last);
+
+    }
+
+#ifdef BUCKET_QUEUES
+    // The new last element of the bucket is the previous element with the
+    // same bucket. On priority ordered queues it is the previous one.
+    if (queue->bucketLast[bucketOf(last)] == last) {
+
+        for (prev = last->prev; prev != NULL; prev = prev->prev) {
+
+            if (bucketOf(prev) == bucketOf(last)) {
+
+                break;
+
+            }
+
+        }
+
+        if (prev != NULL) {
+
+            queue->bucketLast[bucketOf(last)] = prev;
+
+        } else {
+
+            clearBucket(queue, bucketOf(last));
+
+        }
+
+    }
+#endif
+
+    if (queue->size == 1) {
 
         queue->first = queue->last = NULL;
         queue->size = 0;
@@ -265,3 +927,74 @@ PCB_t * extractLast(TaskQueue_t * queue) {
     } 
 
 }
+
+void removePCB(TaskQueue_t * queue, PCB_t * pcb) {
+
+#ifdef BUCKET_QUEUES
+    PCB_t * prev = NULL;
+
+    // If the PCB was the last one of its bucket, the new last one is the
+    // previous element with the same bucket
+    if (queue->bucketLast[bucketOf(pcb)] == pcb) {
+
+        for (prev = pcb->prev; prev != NULL; prev = prev->prev) {
+
+            if (bucketOf(prev) == bucketOf(pcb)) {
+
+                break;
+
+            }
+
+        }
+
+        if (prev != NULL) {
+
+            queue->bucketLast[bucketOf(pcb)] = prev;
+
+        } else {
+
+            clearBucket(queue, bucketOf(pcb));
+
+        }
+
+    }
+#endif
+
+    if (queue->root != NULL) {
+
+        removeNode(queue, pcb);
+
+    }
+
+    if (pcb->prev != NULL) {
+
+        pcb->prev->next = pcb->next;
+
+    } else {
+
+        queue->first = pcb->next;
+
+    }
+
+    if (pcb->next != NULL) {
+
+        pcb->next->prev = pcb->prev;
+
+    } else {
+
+        queue->last = pcb->prev;
+
+    }
+
+    queue->size = queue->size - 1;
+
+    pcb->next = NULL;
+    pcb->prev = NULL;
+
+}
+
+unsigned int getSize(TaskQueue_t * queue) {
+
+    return queue->size;
+
+}
@@ -0,0 +1,429 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <trace.h>
+
+/** Size of the user-space output buffer */
+#define TRACE_BUFFER_SIZE (1 << 20)
+
+/** Initial size of the row buffers */
+#define TRACE_ROW_SIZE 256
+
+/**
+ * @brief Writes a chunk of bytes to the file descriptor.
+ *
+ * If the write fails, the trace is marked as failed.
+ */
+static void writeAll(Trace_t * trace, const char * data, size_t length) {
+
+    size_t written = 0;
+    ssize_t result = 0;
+
+    while (written < length) {
+
+        result = write(trace->fd, data + written, length - written);
+
+        if (result < 0) {
+
+            perror("Error writing the trace");
+            trace->failed = 1;
+            return;
+
+        }
+
+        written = written + result;
+
+    }
+
+}
+
+/**
+ * @brief Writes the contents of the output buffer to the file descriptor.
+ */
+static void flushTrace(Trace_t * trace) {
+
+    if (!trace->failed) {
+
+        writeAll(trace, trace->buffer, trace->bufferLength);
+
+    }
+
+    trace->bufferLength = 0;
+
+}
+
+/**
+ * @brief Appends a chunk of bytes to the output buffer.
+ *
+ * Once the trace has failed, the rest of the output is dropped.
+ */
+static void traceWrite(Trace_t * trace, const void * data, size_t length) {
+
+    if (trace->failed) {
+
+        return;
+
+    }
+
+    if (trace->buffer == NULL) {
+
+        trace->buffer = (char *)malloc(TRACE_BUFFER_SIZE);
+
+        if (trace->buffer == NULL) {
+
+            perror("Not enough memory for the trace");
+            trace->failed = 1;
+            return;
+
+        }
+
+    }
+
+    if (trace->bufferLength + length > TRACE_BUFFER_SIZE) {
+
+        flushTrace(trace);
+
+    }
+
+    if (length > TRACE_BUFFER_SIZE) {
+
+        // Too large to be buffered, write it straight away
+        writeAll(trace, data, length);
+        return;
+
+    }
+
+    memcpy(trace->buffer + trace->bufferLength, data, length);
+    trace->bufferLength = trace->bufferLength + length;
+
+}
+
+/**
+ * @brief Appends an unsigned decimal number to the output buffer.
+ */
+static void traceWriteUnsigned(Trace_t * trace, unsigned int value) {
+
+    char digits[16];
+    int i = sizeof(digits);
+
+    do {
+
+        i = i - 1;
+        digits[i] = '0' + value % 10;
+        value = value / 10;
+
+    } while (value != 0);
+
+    traceWrite(trace, digits + i, sizeof(digits) - i);
+
+}
+
+/**
+ * @brief Makes sure a growable buffer can store a given number of bytes.
+ *
+ * @return 0 on success, -1 if there is not enough memory. The buffer is
+ * then left as it was.
+ */
+static int reserve(char ** data, size_t * capacity, size_t length) {
+
+    size_t grown = *capacity;
+    char * buffer = NULL;
+
+    if (length <= *capacity) {
+
+        return 0;
+
+    }
+
+    while (grown < length) {
+
+        grown = grown == 0 ? TRACE_ROW_SIZE : grown * 2;
+
+    }
+
+    buffer = (char *)realloc(*data, grown);
+
+    if (buffer == NULL) {
+
+        perror("Not enough memory for the trace");
+        return -1;
+
+    }
+
+    *data = buffer;
+    *capacity = grown;
+
+    return 0;
+
+}
+
+/**
+ * @brief Writes a status row for a single tick.
+ */
+static void traceWriteRow(Trace_t * trace, unsigned int clock) {
+
+    traceWriteUnsigned(trace, clock);
+    traceWrite(trace, "\t", 1);
+    traceWrite(trace, trace->row, trace->rowLength);
+    traceWrite(trace, "\n", 1);
+
+}
+
+void openTrace(Trace_t * trace, TraceMode_t mode, unsigned int interval, int fd) {
+
+    TraceHeader_t header;
+
+    memset(trace, 0, sizeof(Trace_t));
+
+    trace->mode = mode;
+    trace->interval = interval == 0 ? 1 : interval;
+    trace->fd = fd;
+
+    if (trace->mode == TRACE_BINARY) {
+
+        header.magic = TRACE_MAGIC;
+        header.version = TRACE_VERSION;
+
+        traceWrite(trace, &header, sizeof(header));
+
+    }
+
+}
+
+int closeTrace(Trace_t * trace) {
+
+    flushTrace(trace);
+
+    free(trace->buffer);
+    free(trace->row);
+    free(trace->lastRow);
+
+    trace->buffer = trace->row = trace->lastRow = NULL;
+    trace->rowCapacity = trace->lastRowCapacity = 0;
+
+    return trace->failed ? -1 : 0;
+
+}
+
+TraceMode_t getTraceMode(Trace_t * trace) {
+
+    return trace->mode;
+
+}
+
+int hasTraceFailed(Trace_t * trace) {
+
+    return trace->failed;
+
+}
+
+void tracePrintf(Trace_t * trace, const char * format, ...) {
+
+    char line[512];
+    int length = 0;
+    va_list args;
+
+    va_start(args, format);
+    length = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+
+    if (length <= 0) {
+
+        return;
+
+    }
+
+    if ((size_t)length >= sizeof(line)) {
+
+        length = sizeof(line) - 1;
+
+    }
+
+    if (trace->mode == TRACE_BINARY) {
+
+        fwrite(line, 1, length, stderr);
+
+    } else {
+
+        traceWrite(trace, line, length);
+
+    }
+
+}
+
+int traceRowsWanted(Trace_t * trace, unsigned int first, unsigned int count,
+                    int idle) {
+
+    unsigned int interval = trace->interval;
+
+    switch (trace->mode) {
+    case TRACE_FULL:
+        return count != 0;
+    case TRACE_SAMPLED:
+        // Check if there is a multiple of the interval in the range
+        return count != 0 &&
+               (first % interval == 0 ||
+                count > interval - first % interval);
+    case TRACE_CHANGES:
+        return count != 0 && (!idle || !trace->lastRowValid);
+    default:
+        return 0;
+    }
+
+}
+
+void traceBeginRow(Trace_t * trace) {
+
+    trace->rowLength = 0;
+
+}
+
+void traceRowString(Trace_t * trace, const char * string) {
+
+    size_t length = strlen(string);
+
+    if (reserve(&(trace->row), &(trace->rowCapacity),
+                trace->rowLength + length) != 0) {
+
+        trace->failed = 1;
+        return;
+
+    }
+
+    memcpy(trace->row + trace->rowLength, string, length);
+    trace->rowLength = trace->rowLength + length;
+
+}
+
+void traceEndRows(Trace_t * trace, unsigned int first, unsigned int count) {
+
+    unsigned int interval = trace->interval;
+    unsigned int clock = 0;
+
+    switch (trace->mode) {
+    case TRACE_FULL:
+        for (clock = first; count != 0; clock++, count--) {
+            traceWriteRow(trace, clock);
+        }
+        break;
+    case TRACE_SAMPLED:
+        // Move to the first multiple of the interval in the range
+        clock = first % interval == 0 ?
+                first : first + (interval - first % interval);
+        while (clock - first < count) {
+            traceWriteRow(trace, clock);
+            if (clock + interval < clock) {
+                break;
+            }
+            clock = clock + interval;
+        }
+        break;
+    case TRACE_CHANGES:
+        if (trace->lastRowValid && trace->lastRowLength == trace->rowLength &&
+            memcmp(trace->lastRow, trace->row, trace->rowLength) == 0) {
+            break;
+        }
+        traceWriteRow(trace, first);
+        if (reserve(&(trace->lastRow), &(trace->lastRowCapacity),
+                    trace->rowLength) != 0) {
+            trace->failed = 1;
+            break;
+        }
+        memcpy(trace->lastRow, trace->row, trace->rowLength);
+        trace->lastRowLength = trace->rowLength;
+        trace->lastRowValid = 1;
+        break;
+    default:
+        break;
+    }
+
+}
+
+void traceArrival(Trace_t * trace, unsigned int clock, unsigned int pid,
+                  const char * command) {
+
+    TraceRecord_t record;
+
+    if (trace->mode != TRACE_BINARY) {
+
+        return;
+
+    }
+
+    record.clock = clock;
+    record.pid = pid;
+    record.type = TRACE_EVENT_ARRIVAL;
+    record.slot = 0;
+    record.length = strlen(command) < 0xffff ? strlen(command) : 0xffff;
+
+    traceWrite(trace, &record, sizeof(record));
+    traceWrite(trace, command, record.length);
+
+}
+
+void traceEvent(Trace_t * trace, unsigned int clock, TraceEventType_t type,
+                unsigned int pid, TraceSlot_t slot) {
+
+    TraceRecord_t record;
+
+    if (trace->mode != TRACE_BINARY) {
+
+        return;
+
+    }
+
+    record.clock = clock;
+    record.pid = pid;
+    record.type = type;
+    record.slot = slot;
+    record.length = 0;
+
+    traceWrite(trace, &record, sizeof(record));
+
+}
+
+void traceDevice(Trace_t * trace, unsigned int device, unsigned int channels,
+                 const char * name) {
+
+    TraceRecord_t record;
+
+    if (trace->mode != TRACE_BINARY) {
+
+        return;
+
+    }
+
+    record.clock = 0;
+    record.pid = channels;
+    record.type = TRACE_EVENT_DEVICE;
+    record.slot = device;
+    record.length = strlen(name);
+
+    traceWrite(trace, &record, sizeof(record));
+    traceWrite(trace, name, record.length);
+
+}
+
+void traceChannel(Trace_t * trace, unsigned int clock, unsigned int pid,
+                  unsigned int device, unsigned int channel) {
+
+    TraceRecord_t record;
+
+    if (trace->mode != TRACE_BINARY) {
+
+        return;
+
+    }
+
+    record.clock = clock;
+    record.pid = pid;
+    record.type = TRACE_EVENT_CHANNEL;
+    record.slot = device;
+    record.length = channel;
+
+    traceWrite(trace, &record, sizeof(record));
+
+}
@@ -0,0 +1,248 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include <trace.h>
+
+/** Commands of the tasks, indexed by PID */
+static char ** commands;
+static unsigned int commandsSize;
+
+/** Names of the devices and their number of channels, indexed by device */
+static char * devices[256];
+static unsigned int channels[256];
+
+/**
+ * @brief Stores the command of a task.
+ *
+ * @param pid PID of the task.
+ * @param command The command, already allocated.
+ */
+static void setCommand(unsigned int pid, char * command) {
+
+    unsigned int size = commandsSize;
+
+    if (pid >= commandsSize) {
+
+        while (size <= pid) {
+
+            size = size == 0 ? 64 : size * 2;
+
+        }
+
+        commands = (char **)realloc(commands, size * sizeof(char *));
+
+        if (commands == NULL) {
+
+            perror("Not enough memory for decoding the trace");
+            exit(-1);
+
+        }
+
+        memset(commands + commandsSize, 0,
+               (size - commandsSize) * sizeof(char *));
+        commandsSize = size;
+
+    }
+
+    free(commands[pid]);
+    commands[pid] = command;
+
+}
+
+/**
+ * @brief Reads the string that follows a record.
+ *
+ * @return The string, allocated with malloc().
+ */
+static char * readString(FILE * input, unsigned int length) {
+
+    char * string = (char *)malloc(length + 1);
+
+    if (string == NULL || fread(string, 1, length, input) != length) {
+
+        fprintf(stderr, "Truncated binary trace\n");
+        exit(-1);
+
+    }
+
+    string[length] = '\0';
+
+    return string;
+
+}
+
+/**
+ * @brief Stores the declaration of a device.
+ *
+ * The name is turned into a slot name: lower case, with dashes instead of
+ * spaces.
+ */
+static void setDevice(unsigned int device, unsigned int count, char * name) {
+
+    char * c = NULL;
+
+    for (c = name; *c != '\0'; c++) {
+
+        *c = *c == ' ' ? '-' : tolower((unsigned char)*c);
+
+    }
+
+    free(devices[device]);
+    devices[device] = name;
+    channels[device] = count;
+
+}
+
+/**
+ * @brief Returns the command of a task.
+ */
+static const char * getCommand(unsigned int pid) {
+
+    if (pid == TRACE_NO_PID) {
+
+        return "(none)";
+
+    }
+
+    if (pid < commandsSize && commands[pid] != NULL) {
+
+        return commands[pid];
+
+    }
+
+    return "(unknown)";
+
+}
+
+int main(int argc, char * argv[]) {
+
+    static const char * slots[] = { "cpu", "hard-disk", "keyboard" };
+    char slotName[48];
+
+    FILE * input = stdin;
+    TraceHeader_t header;
+    TraceRecord_t record;
+    char * command = NULL;
+    unsigned int i = 0;
+
+    if (argc > 2) {
+
+        fprintf(stderr, "Usage: schedsim_tracedump [binary_trace]\n");
+        exit(-1);
+
+    }
+
+    if (argc == 2) {
+
+        input = fopen(argv[1], "rb");
+
+        if (input == NULL) {
+
+            perror("Error opening trace file:");
+            exit(-1);
+
+        }
+
+    }
+
+    if (fread(&header, sizeof(header), 1, input) != 1 ||
+        header.magic != TRACE_MAGIC) {
+
+        fprintf(stderr, "Invalid binary trace\n");
+        exit(-1);
+
+    }
+
+    // Version 1 traces only differ in their fixed hard disk and keyboard
+    if (header.version != TRACE_VERSION && header.version != 1) {
+
+        fprintf(stderr, "Unsupported binary trace version %u\n",
+                header.version);
+        exit(-1);
+
+    }
+
+    printf("Time\tEvent\t\tPID\tCommand\n");
+
+    while (fread(&record, sizeof(record), 1, input) == 1) {
+
+        switch (record.type) {
+        case TRACE_EVENT_ARRIVAL:
+            command = readString(input, record.length);
+            setCommand(record.pid, command);
+            printf("%u\tarrival\t\t%u\t%s\n", record.clock, record.pid,
+                   command);
+            break;
+        case TRACE_EVENT_EXIT:
+            printf("%u\texit\t\t%u\t%s\n", record.clock, record.pid,
+                   getCommand(record.pid));
+            break;
+        case TRACE_EVENT_DEVICE:
+            setDevice(record.slot, record.pid,
+                      readString(input, record.length));
+            break;
+        case TRACE_EVENT_SLOT:
+        case TRACE_EVENT_CHANNEL:
+            if (record.type == TRACE_EVENT_CHANNEL) {
+                if (devices[record.slot] == NULL) {
+                    fprintf(stderr, "Undeclared device %u in binary trace\n",
+                            record.slot);
+                    exit(-1);
+                }
+                // Channels are only told apart on multi-channel devices
+                if (channels[record.slot] > 1) {
+                    snprintf(slotName, sizeof(slotName), "%s/%u",
+                             devices[record.slot], record.length);
+                } else {
+                    snprintf(slotName, sizeof(slotName), "%s",
+                             devices[record.slot]);
+                }
+            } else if (record.slot >= TRACE_SLOT_CPUS) {
+                // Every CPU but the first one has its own slot
+                snprintf(slotName, sizeof(slotName), "cpu%u",
+                         record.slot - TRACE_SLOT_CPUS + 1);
+            } else {
+                snprintf(slotName, sizeof(slotName), "%s", slots[record.slot]);
+            }
+            if (record.pid == TRACE_NO_PID) {
+                printf("%u\t%s\t%s-\t(none)\n", record.clock, slotName,
+                       strlen(slotName) < 8 ? "\t" : "");
+            } else {
+                printf("%u\t%s\t%s%u\t%s\n", record.clock, slotName,
+                       strlen(slotName) < 8 ? "\t" : "",
+                       record.pid, getCommand(record.pid));
+            }
+            break;
+        default:
+            fprintf(stderr, "Invalid event type %u in binary trace\n",
+                    record.type);
+            exit(-1);
+        }
+
+    }
+
+    for (i = 0; i < commandsSize; i++) {
+
+        free(commands[i]);
+
+    }
+
+    free(commands);
+
+    for (i = 0; i < 256; i++) {
+
+        free(devices[i]);
+
+    }
+
+    if (input != stdin) {
+
+        fclose(input);
+
+    }
+
+    return 0;
+
+}
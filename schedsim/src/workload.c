@@ -0,0 +1,524 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <parser.h>
+#include <workload.h>
+
+/** Size of the output buffer of the writer */
+#define WORKLOAD_BUFFER_SIZE (64 * 1024)
+
+/**
+ * Buffered output of a binary workload.
+ */
+typedef struct {
+
+    int fd;
+    /** Non-zero once a write has failed, the rest of the output is dropped */
+    int failed;
+    size_t length;
+    char buffer[WORKLOAD_BUFFER_SIZE];
+
+} WorkloadWriter_t;
+
+/**
+ * @brief Writes the contents of the output buffer to the file descriptor.
+ */
+static void flushWorkload(WorkloadWriter_t * writer) {
+
+    size_t written = 0;
+    ssize_t result = 0;
+
+    while (written < writer->length && !writer->failed) {
+
+        result = write(writer->fd, writer->buffer + written,
+                       writer->length - written);
+
+        if (result < 0) {
+
+            perror("Error writing the workload");
+            writer->failed = 1;
+            break;
+
+        }
+
+        written = written + result;
+
+    }
+
+    writer->length = 0;
+
+}
+
+/**
+ * @brief Appends a chunk of bytes to the output buffer.
+ */
+static void emit(WorkloadWriter_t * writer, const void * data, size_t length) {
+
+    const char * bytes = (const char *)data;
+    size_t chunk = 0;
+
+    while (length != 0) {
+
+        if (writer->length == WORKLOAD_BUFFER_SIZE) {
+
+            flushWorkload(writer);
+
+        }
+
+        chunk = WORKLOAD_BUFFER_SIZE - writer->length;
+
+        if (chunk > length) {
+
+            chunk = length;
+
+        }
+
+        memcpy(writer->buffer + writer->length, bytes, chunk);
+
+        writer->length = writer->length + chunk;
+        bytes = bytes + chunk;
+        length = length - chunk;
+
+    }
+
+}
+
+/**
+ * @brief Rejects a malformed binary workload, unmapping it if it is mapped.
+ *
+ * @return -1.
+ */
+static int invalidWorkload(char * mapping, size_t size, const char * reason) {
+
+    fprintf(stderr, "Invalid binary workload: %s\n", reason);
+
+    if (mapping != NULL) {
+
+        munmap(mapping, size);
+
+    }
+
+    return -1;
+
+}
+
+int isWorkloadFile(int fd) {
+
+    uint32_t magic = 0;
+
+    if (pread(fd, &magic, sizeof(magic), 0) != sizeof(magic)) {
+
+        return 0;
+
+    }
+
+    return magic == WORKLOAD_MAGIC;
+
+}
+
+int loadWorkload(TaskDescriptorList_t * list, int fd) {
+
+    char * mapping = NULL;
+    const WorkloadHeader_t * header = NULL;
+    const WorkloadDevice_t * devices = NULL;
+    const WorkloadTask_t * records = NULL;
+    uint32_t * durations = NULL;
+    uint32_t * sectors = NULL;
+    uint8_t * types = NULL;
+    char * strings = NULL;
+
+    TaskDescriptor_t * descs = NULL;
+
+    off_t size = 0;
+    uint64_t expected = 0, burst = 0;
+    unsigned int i = 0;
+
+    size = lseek(fd, 0, SEEK_END);
+
+    if (size < 0) {
+
+        perror("Error accessing workload file:");
+        return -1;
+
+    }
+
+    if ((size_t)size < sizeof(WorkloadHeader_t)) {
+
+        return invalidWorkload(NULL, 0, "truncated header");
+
+    }
+
+    mapping = (char *)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if (mapping == MAP_FAILED) {
+
+        perror("Error mapping workload file:");
+        return -1;
+
+    }
+
+    header = (const WorkloadHeader_t *)mapping;
+
+    if (header->magic != WORKLOAD_MAGIC) {
+
+        return invalidWorkload(mapping, size, "bad magic number");
+
+    }
+
+    if (header->version != WORKLOAD_VERSION) {
+
+        return invalidWorkload(mapping, size, "unsupported version");
+
+    }
+
+    if (header->devices > MAX_DEVICES) {
+
+        return invalidWorkload(mapping, size, "too many devices");
+
+    }
+
+    // The default devices are a hard disk and a keyboard
+    if ((header->flags & WORKLOAD_IMPLICIT_DEVICES) != 0 &&
+        header->devices != 2) {
+
+        return invalidWorkload(mapping, size, "bad number of default devices");
+
+    }
+
+    // Check the size of every section before trusting any offset. The
+    // counts are bounded by the file size first, so the sum cannot overflow
+
+    if (header->bursts > (uint64_t)size || header->stringsSize > (uint64_t)size) {
+
+        return invalidWorkload(mapping, size, "truncated file");
+
+    }
+
+    if (header->sectors != 0 && header->sectors != header->bursts) {
+
+        return invalidWorkload(mapping, size, "bad number of sectors");
+
+    }
+
+    expected = sizeof(WorkloadHeader_t) +
+               (uint64_t)header->devices * sizeof(WorkloadDevice_t) +
+               (uint64_t)header->tasks * sizeof(WorkloadTask_t) +
+               header->bursts * (sizeof(uint32_t) + sizeof(uint8_t)) +
+               header->sectors * sizeof(uint32_t) +
+               header->stringsSize;
+
+    if (expected != (uint64_t)size) {
+
+        return invalidWorkload(mapping, size,
+                               "the size of the file does not match its header");
+
+    }
+
+    if (header->stringsSize != 0 && mapping[size - 1] != '\0') {
+
+        return invalidWorkload(mapping, size, "unterminated string table");
+
+    }
+
+    devices = (const WorkloadDevice_t *)(header + 1);
+    records = (const WorkloadTask_t *)(devices + header->devices);
+    durations = (uint32_t *)(records + header->tasks);
+    sectors = (uint32_t *)(durations + header->bursts);
+    types = (uint8_t *)(sectors + header->sectors);
+    strings = (char *)(types + header->bursts);
+
+    list->devices.size = header->devices;
+    list->devices.implicit = (header->flags & WORKLOAD_IMPLICIT_DEVICES) != 0;
+
+    for (i = 0; i < header->devices; i++) {
+
+        if (memchr(devices[i].name, '\0', DEVICE_NAME_SIZE) == NULL ||
+            memchr(devices[i].discipline, '\0', DEVICE_NAME_SIZE) == NULL) {
+
+            return invalidWorkload(mapping, size, "unterminated device name");
+
+        }
+
+        if (devices[i].channels == 0 || devices[i].channels > MAX_CHANNELS) {
+
+            return invalidWorkload(mapping, size, "bad number of channels");
+
+        }
+
+        if (devices[i].deadline == 0) {
+
+            return invalidWorkload(mapping, size, "bad deadline");
+
+        }
+
+        memcpy(list->devices.devices[i].name, devices[i].name,
+               DEVICE_NAME_SIZE);
+        list->devices.devices[i].channels = devices[i].channels;
+        list->devices.devices[i].deadline = devices[i].deadline;
+        list->devices.devices[i].seek = devices[i].seek;
+        list->devices.devices[i].discipline =
+            findDiscipline(devices[i].discipline);
+
+        if (list->devices.devices[i].discipline == NULL) {
+
+            return invalidWorkload(mapping, size,
+                                   "unknown queueing discipline");
+
+        }
+
+    }
+
+    for (burst = 0; burst < header->bursts; burst++) {
+
+        if (types[burst] > header->devices) {
+
+            return invalidWorkload(mapping, size, "bad burst type");
+
+        }
+
+    }
+
+    // All the descriptors live in a single chunk of the arena of the list.
+    // Their bursts are never modified, so they are used in place
+
+    descs = (TaskDescriptor_t *)arenaAlloc(&(list->arena),
+                header->tasks * sizeof(TaskDescriptor_t));
+
+    if (descs == NULL && header->tasks != 0) {
+
+        munmap(mapping, size);
+
+        return -1;
+
+    }
+
+    for (i = 0; i < header->tasks; i++) {
+
+        if (records[i].firstBurst > header->bursts ||
+            records[i].bursts > header->bursts - records[i].firstBurst) {
+
+            return invalidWorkload(mapping, size, "burst range out of bounds");
+
+        }
+
+        if (records[i].bursts == 0) {
+
+            return invalidWorkload(mapping, size, "task without bursts");
+
+        }
+
+        if (records[i].command >= header->stringsSize) {
+
+            return invalidWorkload(mapping, size, "command out of bounds");
+
+        }
+
+        if (i != 0 && records[i].startTime < records[i - 1].startTime) {
+
+            return invalidWorkload(mapping, size,
+                                   "tasks not sorted by start time");
+
+        }
+
+        initTaskDescriptor(&(descs[i]));
+
+        descs[i].startTime = records[i].startTime;
+        descs[i].priority = records[i].priority;
+        descs[i].quantum = records[i].quantum;
+        descs[i].partition = records[i].partition;
+        descs[i].pcb.command = strings + records[i].command;
+
+        descs[i].bursts.size = records[i].bursts;
+        descs[i].bursts.types = types + records[i].firstBurst;
+        descs[i].bursts.durations = durations + records[i].firstBurst;
+        descs[i].bursts.sectors = header->sectors != 0 ?
+                                  sectors + records[i].firstBurst : NULL;
+
+        resetTaskDescriptor(&(descs[i]));
+
+        appendDescriptor(list, &(descs[i]));
+
+    }
+
+    // The bursts and the commands point into the mapping, so it lives as
+    // long as the list
+    list->mapping = mapping;
+    list->mappingSize = size;
+
+    return 0;
+
+}
+
+int writeWorkload(TaskDescriptorList_t * list, int fd) {
+
+    WorkloadWriter_t * writer = NULL;
+    WorkloadHeader_t header;
+    WorkloadDevice_t device;
+    WorkloadTask_t record;
+    TaskDescriptor_t * desc = NULL;
+    uint64_t strings = 0;
+    uint32_t sector = 0;
+    unsigned int i = 0;
+    int result = 0;
+
+    writer = (WorkloadWriter_t *)malloc(sizeof(WorkloadWriter_t));
+
+    if (writer == NULL) {
+
+        perror("Not enough memory for writing the workload");
+        return -1;
+
+    }
+
+    writer->fd = fd;
+    writer->failed = 0;
+    writer->length = 0;
+
+    memset(&header, 0, sizeof(header));
+
+    header.magic = WORKLOAD_MAGIC;
+    header.version = WORKLOAD_VERSION;
+    header.tasks = list->size;
+    header.devices = list->devices.size;
+    header.flags = list->devices.implicit ? WORKLOAD_IMPLICIT_DEVICES : 0;
+
+    for (desc = list->first; desc != NULL; desc = desc->next) {
+
+        header.bursts = header.bursts + desc->bursts.size;
+
+        if (desc->bursts.sectors != NULL) {
+
+            header.sectors = 1;
+
+        }
+        header.stringsSize = header.stringsSize + strlen(desc->pcb.command) + 1;
+
+    }
+
+    // If any task gives its sectors, the sectors of every burst are stored
+    if (header.sectors != 0) {
+
+        header.sectors = header.bursts;
+
+    }
+
+    if (header.stringsSize > UINT32_MAX) {
+
+        fprintf(stderr, "The commands of the workload do not fit in a binary "
+                        "workload\n");
+        free(writer);
+        return -1;
+
+    }
+
+    emit(writer, &header, sizeof(header));
+
+    // Device records
+
+    for (i = 0; i < list->devices.size; i++) {
+
+        memset(&device, 0, sizeof(device));
+
+        snprintf(device.name, DEVICE_NAME_SIZE, "%s",
+                 list->devices.devices[i].name);
+        snprintf(device.discipline, DEVICE_NAME_SIZE, "%s",
+                 list->devices.devices[i].discipline->name);
+        device.channels = list->devices.devices[i].channels;
+        device.deadline = list->devices.devices[i].deadline;
+        device.seek = list->devices.devices[i].seek;
+
+        emit(writer, &device, sizeof(device));
+
+    }
+
+    // Task records, with their bursts and commands laid out in order
+
+    memset(&record, 0, sizeof(record));
+
+    for (desc = list->first; desc != NULL; desc = desc->next) {
+
+        record.startTime = desc->startTime;
+        record.priority = desc->priority;
+        record.quantum = desc->quantum;
+        record.partition = desc->partition;
+        record.bursts = desc->bursts.size;
+        record.command = strings;
+
+        emit(writer, &record, sizeof(record));
+
+        record.firstBurst = record.firstBurst + record.bursts;
+        strings = strings + strlen(desc->pcb.command) + 1;
+
+    }
+
+    // Burst durations, burst sectors, then burst types
+
+    for (desc = list->first; desc != NULL; desc = desc->next) {
+
+        emit(writer, desc->bursts.durations,
+             desc->bursts.size * sizeof(uint32_t));
+
+    }
+
+    for (desc = list->first; desc != NULL && header.sectors != 0;
+         desc = desc->next) {
+
+        for (i = 0; i < desc->bursts.size; i++) {
+
+            sector = getBurstSector(&(desc->bursts), i);
+
+            emit(writer, &sector, sizeof(sector));
+
+        }
+
+    }
+
+    for (desc = list->first; desc != NULL; desc = desc->next) {
+
+        emit(writer, desc->bursts.types, desc->bursts.size * sizeof(uint8_t));
+
+    }
+
+    // String table
+
+    for (desc = list->first; desc != NULL; desc = desc->next) {
+
+        emit(writer, desc->pcb.command, strlen(desc->pcb.command) + 1);
+
+    }
+
+    flushWorkload(writer);
+
+    result = writer->failed ? -1 : 0;
+
+    free(writer);
+
+    return result;
+
+}
+
+int readDescriptors(TaskDescriptorList_t * list, int fd, unsigned int threads) {
+
+    if (isWorkloadFile(fd)) {
+
+        // Binary workloads are already sorted by the converter
+        return loadWorkload(list, fd);
+
+    }
+
+    if (parseDescriptorsParallel(list, fd, threads) != 0) {
+
+        return -1;
+
+    }
+
+    sortDescriptorsByStartTime(list);
+
+    return 0;
+
+}